@@ -0,0 +1,214 @@
+#include "AdaptiveReplacementStrategy.h"
+#include "LRUReplacementStrategy.h"
+#include "FIFOReplacementStrategy.h"
+#include "ClockReplacementStrategy.h"
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+
+namespace {
+    const size_t WINDOW_SIZE = 1024;        // Обращений из выборки в одном окне
+    const size_t MIN_GHOST_CAPACITY = 64;   // Меньшие теневые кэши слишком шумные
+    const size_t MAX_SAMPLE_RATE = 16;
+    const size_t MAX_GHOST_CAPACITY = 1024; // Clock ищет страницу перебором, поэтому теневой кэш не растёт с буфером
+    const double SWITCH_MARGIN = 0.05;      // Насколько доля попаданий должна быть выше
+    const size_t SWITCH_WINDOWS = 2;        // Сколько окон подряд
+}
+
+AdaptiveReplacementStrategy::AdaptiveReplacementStrategy(size_t maxPages, ReplacementPolicy initialPolicy)
+    : maxPages_(maxPages), activePolicy_(initialPolicy) {
+    if (maxPages == 0) {
+        throw std::invalid_argument("Buffer must hold at least one page");
+    }
+    sampleRate_ = std::max<size_t>(1, std::min(MAX_SAMPLE_RATE, maxPages / MIN_GHOST_CAPACITY));
+    // Для очень большого буфера выборка становится реже, и теневой кэш по-прежнему моделирует весь буфер
+    sampleRate_ = std::max(sampleRate_, (maxPages + MAX_GHOST_CAPACITY - 1) / MAX_GHOST_CAPACITY);
+    ghostCapacity_ = std::max<size_t>(1, maxPages / sampleRate_);
+
+    active_ = createStrategy(activePolicy_, maxPages_);
+    for (ReplacementPolicy policy : { ReplacementPolicy::LRU, ReplacementPolicy::FIFO, ReplacementPolicy::Clock, ReplacementPolicy::ColdClock }) {
+        GhostCache ghost;
+        ghost.policy = policy;
+        ghost.strategy = createStrategy(policy, ghostCapacity_);
+        ghosts_.push_back(std::move(ghost));
+    }
+    choice_ = "initial policy";
+    reason_ = "not enough sampled accesses yet";
+}
+
+std::unique_ptr<ReplacementStrategy> AdaptiveReplacementStrategy::createStrategy(ReplacementPolicy policy, size_t maxPages) {
+    switch (policy) {
+    case ReplacementPolicy::LRU:
+        return std::make_unique<LRUReplacementStrategy>();
+    case ReplacementPolicy::FIFO:
+        return std::make_unique<FIFOReplacementStrategy>();
+    case ReplacementPolicy::Clock:
+        return std::make_unique<ClockReplacementStrategy>(maxPages);
+    case ReplacementPolicy::ColdClock:
+        return std::make_unique<ClockReplacementStrategy>(maxPages, false);
+    }
+    throw std::invalid_argument("Unknown replacement policy");
+}
+
+const char* AdaptiveReplacementStrategy::getPolicyName(ReplacementPolicy policy) {
+    switch (policy) {
+    case ReplacementPolicy::LRU:
+        return "LRU";
+    case ReplacementPolicy::FIFO:
+        return "FIFO";
+    case ReplacementPolicy::Clock:
+        return "Clock";
+    case ReplacementPolicy::ColdClock:
+        return "Clock (cold insert)";
+    }
+    return "unknown";
+}
+
+void AdaptiveReplacementStrategy::access(size_t pageIndex) {
+    active_->access(pageIndex);
+    recordAccess(pageIndex);
+}
+
+void AdaptiveReplacementStrategy::addPage(size_t pageIndex) {
+    active_->addPage(pageIndex);
+    recordAccess(pageIndex);
+}
+
+size_t AdaptiveReplacementStrategy::evict(const std::function<bool(size_t)>& canEvict) {
+    return active_->evict(canEvict);
+}
+
+void AdaptiveReplacementStrategy::removePage(size_t pageIndex) {
+    active_->removePage(pageIndex);
+}
+
+void AdaptiveReplacementStrategy::clear() {
+    // Теневые кэши не очищаются: они описывают поток обращений, а не содержимое буфера
+    active_->clear();
+}
+
+std::vector<size_t> AdaptiveReplacementStrategy::getEvictionOrder() const {
+    return active_->getEvictionOrder();
+}
+
+void AdaptiveReplacementStrategy::restoreOrder(const std::vector<size_t>& order) {
+    // Перестановка не является обращением к страницам, теневые кэши её не видят
+    active_->restoreOrder(order);
+}
+
+ReplacementSnapshot AdaptiveReplacementStrategy::getSnapshot() const {
+    ReplacementSnapshot snapshot = active_->getSnapshot();
+    snapshot.strategyState = static_cast<uint8_t>(activePolicy_) + 1;
+    return snapshot;
+}
+
+void AdaptiveReplacementStrategy::restoreSnapshot(const ReplacementSnapshot& snapshot) {
+    // Теневые кэши после перезапуска пусты, поэтому без сохранённой политики
+    // адаптивной стратегии пришлось бы заново набирать окна для переключения
+    if (snapshot.strategyState > 0 && snapshot.strategyState <= static_cast<uint8_t>(ReplacementPolicy::ColdClock) + 1) {
+        ReplacementPolicy policy = static_cast<ReplacementPolicy>(snapshot.strategyState - 1);
+        if (policy != activePolicy_) {
+            switchTo(policy);
+            choice_ = "restored after restart";
+        }
+    }
+    active_->restoreSnapshot(snapshot);
+}
+
+void AdaptiveReplacementStrategy::recordAccess(size_t pageIndex) {
+    uint64_t hash = static_cast<uint64_t>(pageIndex) * 0x9E3779B97F4A7C15ULL;
+    if ((hash >> 32) % sampleRate_ != 0) {
+        return;
+    }
+
+    for (auto& ghost : ghosts_) {
+        if (ghost.pages.count(pageIndex) != 0) {
+            ++ghost.hits;
+            ghost.strategy->access(pageIndex);
+            continue;
+        }
+        if (ghost.pages.size() >= ghostCapacity_) {
+            ghost.pages.erase(ghost.strategy->evict());
+        }
+        ghost.pages.insert(pageIndex);
+        ghost.strategy->addPage(pageIndex);
+    }
+
+    if (++windowAccesses_ >= WINDOW_SIZE) {
+        decide();
+    }
+}
+
+void AdaptiveReplacementStrategy::decide() {
+    size_t activeGhost = 0;
+    size_t bestGhost = 0;
+    std::ostringstream ratios;
+    ratios << std::fixed << std::setprecision(2) << "sampled hit ratio";
+    for (size_t i = 0; i < ghosts_.size(); ++i) {
+        if (ghosts_[i].policy == activePolicy_) {
+            activeGhost = i;
+        }
+        if (ghosts_[i].hits > ghosts_[bestGhost].hits) {
+            bestGhost = i;
+        }
+        ratios << (i == 0 ? " " : ", ") << getPolicyName(ghosts_[i].policy) << " "
+            << double(ghosts_[i].hits) / windowAccesses_;
+    }
+
+    double gain = double(ghosts_[bestGhost].hits) - double(ghosts_[activeGhost].hits);
+    if (gain >= SWITCH_MARGIN * windowAccesses_) {
+        if (candidate_ == bestGhost) {
+            ++candidateWindows_;
+        }
+        else {
+            candidate_ = bestGhost;
+            candidateWindows_ = 1;
+        }
+    }
+    else {
+        candidateWindows_ = 0;
+    }
+
+    if (candidateWindows_ >= SWITCH_WINDOWS) {
+        std::string previous = getPolicyName(activePolicy_);
+        switchTo(ghosts_[bestGhost].policy);
+        ++switchCount_;
+        choice_ = "switched from " + previous + ", " + ratios.str();
+        reason_ = "just switched";
+        candidateWindows_ = 0;
+    }
+    else if (candidateWindows_ > 0) {
+        reason_ = std::string(getPolicyName(ghosts_[bestGhost].policy)) + " is ahead, waiting for confirmation: " + ratios.str();
+    }
+    else {
+        reason_ = "no policy is clearly better: " + ratios.str();
+    }
+
+    for (auto& ghost : ghosts_) {
+        ghost.hits = 0;
+    }
+    windowAccesses_ = 0;
+}
+
+void AdaptiveReplacementStrategy::switchTo(ReplacementPolicy policy) {
+    // Страницы передаются в порядке вытеснения старой политики: первой новая вытеснит ту же страницу
+    std::unique_ptr<ReplacementStrategy> next = createStrategy(policy, maxPages_);
+    for (size_t pageIndex : active_->getEvictionOrder()) {
+        next->addPage(pageIndex);
+    }
+    active_ = std::move(next);
+    activePolicy_ = policy;
+}
+
+std::string AdaptiveReplacementStrategy::getDescription() const {
+    return std::string("Adaptive: ") + getPolicyName(activePolicy_) + " (" + choice_ + "; last window: " + reason_ + ")";
+}
+
+ReplacementPolicy AdaptiveReplacementStrategy::getActivePolicy() const {
+    return activePolicy_;
+}
+
+size_t AdaptiveReplacementStrategy::getSwitchCount() const {
+    return switchCount_;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "ReplacementStrategy.h"
+#include <memory>
+#include <vector>
+#include <string>
+#include <unordered_set>
+
+enum class ReplacementPolicy {
+    LRU,
+    FIFO,
+    Clock,
+    ColdClock  // Clock, в котором новая страница не получает бит обращения
+};
+
+// Стратегия, которая сама выбирает политику замещения во время работы.
+// Часть обращений (по хешу номера страницы) проигрывается на теневых кэшах всех политик:
+// теневой кэш хранит только номера страниц, его размер уменьшен пропорционально доле выборки.
+// После каждого окна обращений сравниваются доли попаданий; если другая политика заметно
+// лучше активной несколько окон подряд, страницы буфера передаются ей в порядке вытеснения.
+class AdaptiveReplacementStrategy : public ReplacementStrategy {
+public:
+    explicit AdaptiveReplacementStrategy(size_t maxPages, ReplacementPolicy initialPolicy = ReplacementPolicy::LRU);
+
+    void access(size_t pageIndex) override;
+    void addPage(size_t pageIndex) override;
+    using ReplacementStrategy::evict;
+    size_t evict(const std::function<bool(size_t)>& canEvict) override;
+    void removePage(size_t pageIndex) override;
+    void clear() override;
+    std::vector<size_t> getEvictionOrder() const override;
+    void restoreOrder(const std::vector<size_t>& order) override; // Без учёта в теневых кэшах
+    ReplacementSnapshot getSnapshot() const override;             // Снимок активной политики и её номер
+    void restoreSnapshot(const ReplacementSnapshot& snapshot) override; // Сначала возвращает сохранённую политику
+    std::string getDescription() const override; // Активная политика и причина выбора
+
+    ReplacementPolicy getActivePolicy() const;
+    size_t getSwitchCount() const;
+
+    static std::unique_ptr<ReplacementStrategy> createStrategy(ReplacementPolicy policy, size_t maxPages);
+    static const char* getPolicyName(ReplacementPolicy policy);
+
+private:
+    struct GhostCache {
+        ReplacementPolicy policy;
+        std::unique_ptr<ReplacementStrategy> strategy;
+        std::unordered_set<size_t> pages;
+        size_t hits = 0; // Попадания в текущем окне
+    };
+
+    void recordAccess(size_t pageIndex);
+    void decide();
+    void switchTo(ReplacementPolicy policy);
+
+    size_t maxPages_;
+    size_t sampleRate_;      // В выборку попадает одна страница из sampleRate_
+    size_t ghostCapacity_;
+
+    ReplacementPolicy activePolicy_;
+    std::unique_ptr<ReplacementStrategy> active_;
+
+    std::vector<GhostCache> ghosts_;
+    size_t windowAccesses_ = 0;
+    size_t candidate_ = 0;       // Политика, которая лучше активной в последних окнах
+    size_t candidateWindows_ = 0;
+    size_t switchCount_ = 0;
+    std::string choice_;  // Почему выбрана активная политика
+    std::string reason_;  // Итог последнего окна
+};
@@ -0,0 +1,263 @@
+#include "BPlusTree.h"
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    const uint8_t LEAF_NODE = 1;
+    const uint8_t INNER_NODE = 0;
+}
+
+BPlusTree::BPlusTree(BufferManager& bufferManager, size_t rootPageIndex)
+    : bufferManager_(bufferManager), rootPageIndex_(rootPageIndex) {
+    PinnedPage(bufferManager_, rootPageIndex_).read([](const Page& page) {
+        if (page.getRecordCount() == 0 || page.getRecord(0).size() != 2) {
+            throw std::runtime_error("Page is not a B+-tree node");
+        }
+    });
+}
+
+size_t BPlusTree::build(BufferManager& bufferManager, const std::vector<std::vector<uint8_t>>& keys,
+    const std::vector<RID>& rids, double fillFactor) {
+    if (keys.size() != rids.size()) {
+        throw std::invalid_argument("Keys and RIDs do not match");
+    }
+    if (fillFactor <= 0 || fillFactor > 1) {
+        throw std::invalid_argument("Fill factor must be in (0, 1]");
+    }
+    // Вместимость узла вместе со слотами записей; узлы заполняются до target
+    size_t capacity = Page().getFreeSpace() + Page::getRecordOverhead();
+    size_t target = static_cast<size_t>(fillFactor * capacity);
+
+    // Текущий уровень: наименьший ключ и страница каждого узла
+    std::vector<std::vector<uint8_t>> levelKeys;
+    std::vector<size_t> levelPages;
+    uint8_t level = 0;
+    do {
+        bool leaf = level == 0;
+        size_t count = leaf ? keys.size() : levelKeys.size();
+        std::vector<Page> nodes;
+        std::vector<size_t> firstEntries; // Номер первого элемента в каждом узле
+        size_t used = 0;
+
+        for (size_t i = 0; i < count || nodes.empty(); ++i) {
+            std::vector<uint8_t> entry;
+            if (i < count) {
+                const std::vector<uint8_t>& key = leaf ? keys[i] : levelKeys[i];
+                if (key.size() > MAX_KEY_SIZE) {
+                    throw std::runtime_error("Key is too long for B+-tree");
+                }
+                if (leaf && i > 0 && !(keys[i - 1] < key)) {
+                    throw std::runtime_error("B+-tree keys must be sorted and unique");
+                }
+                entry.resize(leaf ? LEAF_ENTRY_HEADER : INNER_ENTRY_HEADER);
+                if (leaf) {
+                    uint64_t pageIndex = rids[i].pageIndex;
+                    uint16_t slot = static_cast<uint16_t>(rids[i].slot);
+                    std::memcpy(entry.data(), &pageIndex, 8);
+                    std::memcpy(entry.data() + 8, &slot, 2);
+                }
+                else {
+                    uint64_t child = levelPages[i];
+                    std::memcpy(entry.data(), &child, 8);
+                }
+                entry.insert(entry.end(), key.begin(), key.end());
+            }
+
+            // Новый узел, если текущий заполнен до fillFactor (но не меньше двух элементов)
+            size_t size = entry.size() + Page::getRecordOverhead();
+            bool full = !nodes.empty() && i < count
+                && (used + size > capacity || (nodes.back().getRecordCount() > 2 && used + size > target));
+            if (nodes.empty() || full) {
+                nodes.emplace_back();
+                nodes.back().appendRecord({ leaf ? LEAF_NODE : INNER_NODE, level });
+                used = 2 + Page::getRecordOverhead();
+                firstEntries.push_back(i);
+            }
+            if (i < count) {
+                nodes.back().appendRecord(entry);
+                used += size;
+            }
+        }
+
+        // Узлы уровня пишутся подряд и связываются в цепочку
+        size_t firstPage = bufferManager.reservePages(nodes.size());
+        for (size_t n = 0; n + 1 < nodes.size(); ++n) {
+            nodes[n].setNextPage(firstPage + n + 1);
+        }
+        bufferManager.writePagesDirect(firstPage, nodes);
+
+        std::vector<std::vector<uint8_t>> parentKeys;
+        std::vector<size_t> parentPages;
+        for (size_t n = 0; n < nodes.size(); ++n) {
+            size_t first = firstEntries[n];
+            if (first < count) {
+                parentKeys.push_back(leaf ? keys[first] : levelKeys[first]);
+            }
+            else {
+                parentKeys.emplace_back(); // Пустое дерево
+            }
+            parentPages.push_back(firstPage + n);
+        }
+        levelKeys = std::move(parentKeys);
+        levelPages = std::move(parentPages);
+        ++level;
+    } while (levelPages.size() > 1);
+
+    return levelPages[0];
+}
+
+std::vector<uint8_t> BPlusTree::encodeKey(const Table& table, const std::vector<Value>& keyValues) {
+    if (keyValues.size() != table.primaryKey.size()) {
+        throw std::runtime_error("Key does not match primary key of table " + table.name);
+    }
+
+    std::vector<uint8_t> key;
+    for (size_t i = 0; i < keyValues.size(); ++i) {
+        appendKeyValue(key, table.columns[table.primaryKey[i]], keyValues[i]);
+    }
+    return key;
+}
+
+std::vector<uint8_t> BPlusTree::encodeRowKey(const Table& table, const Row& row) {
+    if (row.size() != table.columns.size()) {
+        throw std::runtime_error("Row does not match table schema.");
+    }
+    std::vector<uint8_t> key;
+    for (size_t column : table.primaryKey) {
+        appendKeyValue(key, table.columns[column], row[column]);
+    }
+    return key;
+}
+
+void BPlusTree::appendKeyValue(std::vector<uint8_t>& key, const Column& column, const Value& keyValue) {
+    if (column.type == "INT") {
+        // Старшим байтом вперёд с инвертированным знаком: побайтный порядок совпадает с числовым
+        uint64_t value = static_cast<uint64_t>(std::get<int64_t>(keyValue)) ^ (uint64_t(1) << 63);
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            key.push_back(static_cast<uint8_t>(value >> shift));
+        }
+        return;
+    }
+
+    const std::string& value = std::get<std::string>(keyValue);
+    if (column.size != 0) {
+        if (value.size() > column.size) {
+            throw std::runtime_error("Value is too long for column " + column.name);
+        }
+        key.insert(key.end(), value.begin(), value.end());
+        key.resize(key.size() + column.size - value.size(), 0);
+    }
+    else {
+        // Строка переменной длины: 0x00 экранируется как 0x00 0xFF, конец - 0x00 0x00
+        for (char c : value) {
+            key.push_back(static_cast<uint8_t>(c));
+            if (c == 0) {
+                key.push_back(0xFF);
+            }
+        }
+        key.push_back(0);
+        key.push_back(0);
+    }
+}
+
+int BPlusTree::compareKey(const std::vector<uint8_t>& entry, size_t entryHeader, const std::vector<uint8_t>& key) {
+    size_t entryKeySize = entry.size() - entryHeader;
+    size_t common = std::min(entryKeySize, key.size());
+    int result = common == 0 ? 0 : std::memcmp(entry.data() + entryHeader, key.data(), common);
+    if (result != 0) {
+        return result;
+    }
+    return entryKeySize < key.size() ? -1 : (entryKeySize > key.size() ? 1 : 0);
+}
+
+size_t BPlusTree::upperBound(const Page& page, size_t entryHeader, const std::vector<uint8_t>& key) {
+    size_t low = 1;
+    size_t high = page.getRecordCount();
+    while (low < high) {
+        size_t middle = (low + high) / 2;
+        if (compareKey(page.getRecord(middle), entryHeader, key) <= 0) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+size_t BPlusTree::findLeaf(const std::vector<uint8_t>& key) {
+    size_t pageIndex = rootPageIndex_;
+    while (true) {
+        bool leaf = false;
+        PinnedPage(bufferManager_, pageIndex).read([&](const Page& page) {
+            leaf = page.getRecord(0)[0] == LEAF_NODE;
+            if (leaf || page.getRecordCount() < 2) {
+                return;
+            }
+            // Последний элемент с ключом не больше искомого; если такого нет - самый левый
+            size_t position = std::max<size_t>(upperBound(page, INNER_ENTRY_HEADER, key), 2) - 1;
+            uint64_t child;
+            std::memcpy(&child, page.getRecord(position).data(), 8);
+            pageIndex = static_cast<size_t>(child);
+        });
+        if (leaf) {
+            return pageIndex;
+        }
+    }
+}
+
+bool BPlusTree::find(const std::vector<uint8_t>& key, RID& rid) {
+    bool found = false;
+    PinnedPage(bufferManager_, findLeaf(key)).read([&](const Page& page) {
+        size_t position = upperBound(page, LEAF_ENTRY_HEADER, key);
+        if (position > 1) {
+            std::vector<uint8_t> entry = page.getRecord(position - 1);
+            if (compareKey(entry, LEAF_ENTRY_HEADER, key) == 0) {
+                uint64_t pageIndex;
+                uint16_t slot;
+                std::memcpy(&pageIndex, entry.data(), 8);
+                std::memcpy(&slot, entry.data() + 8, 2);
+                rid = { static_cast<size_t>(pageIndex), slot };
+                found = true;
+            }
+        }
+    });
+    return found;
+}
+
+std::vector<RID> BPlusTree::findRange(const std::vector<uint8_t>& low, const std::vector<uint8_t>& high) {
+    std::vector<RID> result;
+    bool done = false;
+    for (size_t pageIndex = findLeaf(low); pageIndex != INVALID_PAGE && !done; ) {
+        PinnedPage(bufferManager_, pageIndex).read([&](const Page& page) {
+            for (size_t slot = 1; slot < page.getRecordCount(); ++slot) {
+                std::vector<uint8_t> entry = page.getRecord(slot);
+                if (compareKey(entry, LEAF_ENTRY_HEADER, low) < 0) {
+                    continue;
+                }
+                if (compareKey(entry, LEAF_ENTRY_HEADER, high) > 0) {
+                    done = true;
+                    break;
+                }
+                uint64_t ridPage;
+                uint16_t ridSlot;
+                std::memcpy(&ridPage, entry.data(), 8);
+                std::memcpy(&ridSlot, entry.data() + 8, 2);
+                result.push_back({ static_cast<size_t>(ridPage), ridSlot });
+            }
+            pageIndex = page.getNextPage();
+        });
+    }
+    return result;
+}
+
+size_t BPlusTree::getRootPage() const {
+    return rootPageIndex_;
+}
+
+size_t BPlusTree::getHeight() {
+    size_t height = 0;
+    PinnedPage(bufferManager_, rootPageIndex_).read([&](const Page& page) { height = page.getRecord(0)[1] + size_t(1); });
+    return height;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <vector>
+#include "BufferManager.h"
+#include "HeapFile.h"
+#include "Table.h"
+
+// B+-дерево первичного ключа на страницах BufferManager.
+// Первая запись каждого узла - [лист?][уровень], дальше элементы по возрастанию ключа:
+// в листьях [RID][ключ], во внутренних узлах [дочерняя страница][наименьший ключ поддерева].
+// Листья (и узлы каждого уровня) связаны ссылкой на следующую страницу.
+//
+// Дерево строится снизу вверх по отсортированным ключам (build), после этого только читается.
+// Ключи кодируются с сохранением порядка, поэтому сравниваются побайтно.
+class BPlusTree {
+public:
+    // Открывает дерево по корневой странице
+    BPlusTree(BufferManager& bufferManager, size_t rootPageIndex);
+
+    // Строит дерево по ключам, отсортированным по возрастанию без повторов.
+    // Узлы заполняются на fillFactor и пишутся подряд в обход буфера. Возвращает корень.
+    static size_t build(BufferManager& bufferManager, const std::vector<std::vector<uint8_t>>& keys,
+        const std::vector<RID>& rids, double fillFactor);
+
+    // Ключ из значений колонок первичного ключа таблицы (в порядке table.primaryKey)
+    static std::vector<uint8_t> encodeKey(const Table& table, const std::vector<Value>& keyValues);
+    static std::vector<uint8_t> encodeRowKey(const Table& table, const Row& row); // Ключ из всей строки таблицы
+
+    bool find(const std::vector<uint8_t>& key, RID& rid);
+    std::vector<RID> findRange(const std::vector<uint8_t>& low, const std::vector<uint8_t>& high); // [low, high]
+
+    size_t getRootPage() const;
+    size_t getHeight();
+
+private:
+    static const size_t MAX_KEY_SIZE = 1024;
+    static const size_t LEAF_ENTRY_HEADER = 10; // Страница RID 8 байт, слот 2 байта
+    static const size_t INNER_ENTRY_HEADER = 8; // Дочерняя страница
+
+    // Дерево не меняется после построения, поэтому страницы читаются через PinnedPage::read без защёлки
+    size_t findLeaf(const std::vector<uint8_t>& key); // Лист, в котором может быть ключ
+
+    // Позиция первого элемента узла с ключом больше key (элементы начинаются со слота 1)
+    static size_t upperBound(const Page& page, size_t entryHeader, const std::vector<uint8_t>& key);
+    static int compareKey(const std::vector<uint8_t>& entry, size_t entryHeader, const std::vector<uint8_t>& key);
+    static void appendKeyValue(std::vector<uint8_t>& key, const Column& column, const Value& keyValue);
+
+    BufferManager& bufferManager_;
+    size_t rootPageIndex_;
+};
@@ -1,54 +1,284 @@
 #include "BufferManager.h"
 #include <stdexcept>
-#include <iostream> //  std::cout
+#include <algorithm>
+#include <iostream> // Для std::cout
 
-BufferManager::BufferManager(size_t maxPages, const std::string& fileName, std::unique_ptr<ReplacementStrategy> strategy)
-    : maxPages_(maxPages), fileManager_(fileName), replacementStrategy_(std::move(strategy)) {
+const size_t LATCH_COUNT = 1024; // Число защёлок страниц
+
+BufferManager::BufferManager(size_t maxPages, const std::string& fileName, std::unique_ptr<ReplacementStrategy> strategy,
+    CompressionMode compression, std::unique_ptr<CompressedPageCache> secondTier)
+    : maxPages_(maxPages), fileManager_(fileName, compression), replacementStrategy_(std::move(strategy)),
+    secondTier_(std::move(secondTier)) {
+    nextPageIndex_ = fileManager_.getPageCount();
+    latches_ = std::make_unique<std::shared_mutex[]>(LATCH_COUNT);
 }
 
 Page& BufferManager::getPage(size_t pageIndex) {
-    //     
-    if (frames_.find(pageIndex) != frames_.end()) {
-        replacementStrategy_->access(pageIndex); //    
-        return frames_[pageIndex].page;
+    Page* page;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        page = &loadFrame(pageIndex).page;
+    }
+    admitEvicted();
+    return *page;
+}
+
+Page& BufferManager::pinPage(size_t pageIndex) {
+    Page* page;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Frame& frame = loadFrame(pageIndex);
+        ++frame.pinCount;
+        page = &frame.page;
+    }
+    admitEvicted();
+    return *page;
+}
+
+void BufferManager::unpinPage(size_t pageIndex) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = frames_.find(pageIndex);
+    if (it == frames_.end() || it->second.pinCount == 0) {
+        throw std::runtime_error("Page is not pinned.");
+    }
+    --it->second.pinCount;
+}
+
+size_t BufferManager::allocatePage() {
+    size_t pageIndex;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (frames_.size() >= maxPages_) {
+            evictPage();
+        }
+
+        pageIndex = nextPageIndex_++;
+        frames_[pageIndex] = { Page(), true }; // Страницы ещё нет на диске
+        replacementStrategy_->addPage(pageIndex);
+    }
+    admitEvicted();
+    return pageIndex;
+}
+
+size_t BufferManager::reservePages(size_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t firstPageIndex = nextPageIndex_;
+    nextPageIndex_ += count;
+    return firstPageIndex;
+}
+
+void BufferManager::writePagesDirect(size_t firstPageIndex, const std::vector<Page>& pages) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (firstPageIndex + pages.size() > nextPageIndex_) {
+        throw std::runtime_error("Pages were not reserved.");
+    }
+    for (size_t i = 0; i < pages.size(); ++i) {
+        if (frames_.count(firstPageIndex + i) != 0) {
+            throw std::runtime_error("Page is already in buffer.");
+        }
+        if (secondTier_) {
+            secondTier_->erase(firstPageIndex + i);
+            dropAdmission(firstPageIndex + i);
+        }
+        fileManager_.writePage(firstPageIndex + i, pages[i]);
+    }
+}
+
+BufferManager::Frame& BufferManager::loadFrame(size_t pageIndex) {
+    // Если страница уже в буфере
+    auto it = frames_.find(pageIndex);
+    if (it != frames_.end()) {
+        ++hitCount_;
+        it->second.reused = true;
+        it->second.prefetched = false;
+        replacementStrategy_->access(pageIndex); // Уведомляем стратегию о доступе
+        return it->second;
     }
+    ++missCount_;
 
-    //   ,  
+    // Если буфер заполнен, замещаем страницу
     if (frames_.size() >= maxPages_) {
         evictPage();
     }
 
-    //    
-    Page newPage = fileManager_.readPage(pageIndex);
-    frames_[pageIndex] = { newPage, false }; //   
-    replacementStrategy_->addPage(pageIndex); //     
+    // Загрузка страницы прямо в кадр буфера
+    Frame& frame = frames_[pageIndex];
+    frame.isDirty = false; // Страница не изменялась
+    try {
+        readFrame(pageIndex, frame);
+    }
+    catch (...) {
+        frames_.erase(pageIndex);
+        throw;
+    }
+    replacementStrategy_->addPage(pageIndex); // Уведомляем стратегию о новой странице
 
-    return frames_[pageIndex].page;
+    return frame;
 }
 
-void BufferManager::writePage(size_t pageIndex, const Page& page) {
-    if (frames_.find(pageIndex) == frames_.end()) {
+void BufferManager::readFrame(size_t pageIndex, Frame& frame) {
+    if (!secondTier_) {
+        fileManager_.readPage(pageIndex, frame.page);
+        return;
+    }
+    dropAdmission(pageIndex); // Копия ещё не сжата, а страница уже снова нужна
+    if (secondTier_->take(pageIndex, frame.page)) {
+        return;
+    }
+    fileManager_.readPage(pageIndex, frame.page);
+}
+
+std::shared_mutex& BufferManager::getPageLatch(size_t pageIndex) {
+    return latches_[pageIndex % LATCH_COUNT];
+}
+
+void BufferManager::markDirty(size_t pageIndex) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = frames_.find(pageIndex);
+    if (it == frames_.end()) {
+        throw std::runtime_error("Page is not in buffer.");
+    }
+    it->second.isDirty = true;
+}
+
+std::vector<size_t> BufferManager::getResidentPages() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return replacementStrategy_->getEvictionOrder();
+}
+
+size_t BufferManager::prefetchPages(const std::vector<size_t>& pageIndices) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t loaded = 0;
+    for (size_t pageIndex : pageIndices) {
         if (frames_.size() >= maxPages_) {
-            evictPage();
+            break;
+        }
+        if (pageIndex >= nextPageIndex_ || frames_.count(pageIndex) != 0) {
+            continue;
         }
 
-        frames_[pageIndex] = { page, true }; //       
-        replacementStrategy_->addPage(pageIndex); //     
+        Frame& frame = frames_[pageIndex];
+        frame.isDirty = false;
+        try {
+            readFrame(pageIndex, frame);
+        }
+        catch (...) {
+            frames_.erase(pageIndex);
+            throw;
+        }
+        frame.prefetched = true;
+        replacementStrategy_->addPage(pageIndex);
+        ++loaded;
     }
-    else {
-        frames_[pageIndex].page = page;
-        frames_[pageIndex].isDirty = true;
-        replacementStrategy_->access(pageIndex); //    
+    return loaded;
+}
+
+ReplacementSnapshot BufferManager::getReplacementSnapshot() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return replacementStrategy_->getSnapshot();
+}
+
+void BufferManager::restoreReplacementSnapshot(const ReplacementSnapshot& snapshot) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool hasStates = snapshot.states.size() == snapshot.pages.size();
+    ReplacementSnapshot untouched;
+    untouched.strategyState = snapshot.strategyState;
+    for (size_t i = 0; i < snapshot.pages.size(); ++i) {
+        auto it = frames_.find(snapshot.pages[i]);
+        if (it == frames_.end() || !it->second.prefetched) {
+            continue;
+        }
+        untouched.pages.push_back(snapshot.pages[i]);
+        if (hasStates) {
+            untouched.states.push_back(snapshot.states[i]);
+        }
     }
+    replacementStrategy_->restoreSnapshot(untouched);
+}
+
+const CompressionStats& BufferManager::getCompressionStats() const {
+    return fileManager_.getStats();
+}
+
+CompressedCacheStats BufferManager::getSecondTierStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return secondTier_ ? secondTier_->getStats() : CompressedCacheStats();
+}
+
+size_t BufferManager::getHitCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hitCount_;
+}
+
+size_t BufferManager::getMissCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return missCount_;
+}
+
+std::string BufferManager::getReplacementPolicy() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return replacementStrategy_->getDescription();
+}
+
+void BufferManager::setLogging(bool enabled) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    logging_ = enabled;
+    fileManager_.setLogging(enabled);
+}
+
+void BufferManager::writePage(size_t pageIndex, const Page& page) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pageIndex >= nextPageIndex_) {
+            nextPageIndex_ = pageIndex + 1;
+        }
+
+        if (frames_.find(pageIndex) == frames_.end()) {
+            if (frames_.size() >= maxPages_) {
+                evictPage();
+            }
+
+            frames_[pageIndex] = { page, true }; // Добавляем страницу и помечаем её как изменённую
+            replacementStrategy_->addPage(pageIndex); // Уведомляем стратегию о новой странице
+            if (secondTier_) {
+                secondTier_->erase(pageIndex); // Сжатая копия устарела
+                dropAdmission(pageIndex);
+            }
+        }
+        else {
+            Frame& frame = frames_[pageIndex];
+            frame.page = page;
+            frame.isDirty = true;
+            frame.reused = true;
+            frame.prefetched = false;
+            replacementStrategy_->access(pageIndex); // Уведомляем стратегию о доступе
+        }
+    }
+    admitEvicted();
 }
 
 void BufferManager::flushAll() {
-    for (auto& entry : frames_) {
-        if (entry.second.isDirty) {
-            fileManager_.writePage(entry.first, entry.second.page);
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Закреплённые страницы используются другими потоками: записываем их, но оставляем в буфере
+    for (auto it = frames_.begin(); it != frames_.end(); ) {
+        if (it->second.isDirty) {
+            std::shared_lock<std::shared_mutex> latch(getPageLatch(it->first));
+            fileManager_.writePage(it->first, it->second.page);
+            it->second.isDirty = false;
+        }
+        if (it->second.pinCount != 0) {
+            ++it;
+            continue;
         }
+        replacementStrategy_->removePage(it->first);
+        it = frames_.erase(it);
     }
-    frames_.clear();
+    if (secondTier_) {
+        secondTier_->clear(); // Во втором уровне только незакреплённые чистые страницы
+        admissions_.clear();
+        admissionTickets_.clear();
+    }
+    fileManager_.saveIndex();
 }
 
 void BufferManager::evictPage() {
@@ -56,21 +286,105 @@ void BufferManager::evictPage() {
         throw std::runtime_error("No pages to evict.");
     }
 
-    size_t pageIndex = replacementStrategy_->evict(); //     
+    // Стратегия выбирает страницу для замещения, пропуская закреплённые: они не теряют
+    // своего места в порядке вытеснения и не учитываются как обращения
+    if (std::all_of(frames_.begin(), frames_.end(), [](const auto& entry) { return entry.second.pinCount != 0; })) {
+        throw std::runtime_error("All pages in buffer are pinned.");
+    }
+    size_t pageIndex = replacementStrategy_->evict([this](size_t candidate) {
+        auto frame = frames_.find(candidate);
+        return frame == frames_.end() || frame->second.pinCount == 0;
+    });
 
-    //   
+    // Проверяем наличие страницы
     auto it = frames_.find(pageIndex);
     if (it == frames_.end()) {
         throw std::runtime_error("Page to evict not found in buffer.");
     }
 
-    std::cout << "Evicting page " << pageIndex << " from buffer.\n";
+    if (logging_) {
+        std::cout << "Evicting page " << pageIndex << " from buffer.\n";
+    }
 
     if (it->second.isDirty) {
         fileManager_.writePage(pageIndex, it->second.page);
-        std::cout << "Page " << pageIndex << " written to disk before eviction.\n";
+        if (logging_) {
+            std::cout << "Page " << pageIndex << " written to disk before eviction.\n";
+        }
+    }
+
+    // После записи страница чистая, её сжатая копия совпадает с диском. Страницу, прочитанную
+    // один раз (например, при сканировании), сжимать незачем: повторного обращения, скорее всего, не будет.
+    // Сжатие дорогое, поэтому здесь страница только откладывается, а сжимает её admitEvicted без mutex_
+    if (secondTier_ && it->second.reused) {
+        uint64_t ticket = ++nextTicket_;
+        admissionTickets_[pageIndex] = ticket;
+        admissions_.push_back({ pageIndex, std::move(it->second.page), ticket });
     }
 
-    frames_.erase(it); //    
-    std::cout << "Page " << pageIndex << " evicted.\n";
+    frames_.erase(it); // Удаляем страницу из буфера
+    if (logging_) {
+        std::cout << "Page " << pageIndex << " evicted.\n";
+    }
+}
+
+void BufferManager::dropAdmission(size_t pageIndex) {
+    admissionTickets_.erase(pageIndex);
+}
+
+void BufferManager::admitEvicted() {
+    std::vector<Admission> admissions;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (admissions_.empty()) {
+            return;
+        }
+        admissions.swap(admissions_);
+    }
+
+    for (Admission& admission : admissions) {
+        double seconds = 0;
+        std::vector<uint8_t> data = secondTier_->compress(admission.page, seconds);
+
+        // Пока страница сжималась, её могли снова загрузить или перезаписать - тогда копия устарела
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto ticket = admissionTickets_.find(admission.pageIndex);
+        if (ticket == admissionTickets_.end() || ticket->second != admission.ticket) {
+            continue;
+        }
+        admissionTickets_.erase(ticket);
+        secondTier_->put(admission.pageIndex, std::move(data), seconds);
+    }
+}
+
+PinnedPage::PinnedPage(BufferManager& bufferManager, size_t pageIndex)
+    : bufferManager_(bufferManager), pageIndex_(pageIndex), page_(bufferManager.pinPage(pageIndex)) {
+}
+
+PinnedPage::~PinnedPage() {
+    bufferManager_.unpinPage(pageIndex_);
+}
+
+const Page& PinnedPage::operator*() const {
+    return page_;
+}
+
+const Page* PinnedPage::operator->() const {
+    return &page_;
+}
+
+void PinnedPage::read(const std::function<void(const Page&)>& read) const {
+    read(page_);
+}
+
+std::shared_lock<std::shared_mutex> PinnedPage::lockShared() const {
+    return std::shared_lock<std::shared_mutex>(bufferManager_.getPageLatch(pageIndex_));
+}
+
+void PinnedPage::modify(const std::function<void(Page&)>& modify) {
+    {
+        std::unique_lock<std::shared_mutex> latch(bufferManager_.getPageLatch(pageIndex_));
+        modify(page_);
+    }
+    bufferManager_.markDirty(pageIndex_);
 }
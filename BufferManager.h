@@ -27,20 +27,20 @@ public:
 private:
     struct Frame {
         Page page;
-        bool isDirty; //      
+        bool isDirty; // Нужно ли записать страницу на диск
     };
 
     std::unique_ptr<ReplacementStrategy> replacementStrategy_;
 
-    size_t maxPages_;                              //     
-    std::unordered_map<size_t, std::list<size_t>::iterator> pageTable_; //    
-    std::list<size_t> lruList_;                    //  LRU:   
-    std::unordered_map<size_t, Frame> frames_;     //    
+    size_t maxPages_;                              // Максимальное количество страниц в буфере
+    std::unordered_map<size_t, std::list<size_t>::iterator> pageTable_; // Индекс страниц в памяти
+    std::list<size_t> lruList_;                    // Для LRU: отслеживаем порядок использования
+    std::unordered_map<size_t, Frame> frames_;     // Храним страницы в памяти
     FileManager fileManager_;
 
     
 
-    void evictPage(); //  
+    void evictPage(); // Замещение страниц
 };
 
 */
@@ -49,27 +49,118 @@ private:
 #include "Page.h"
 #include "FileManager.h"
 #include "ReplacementStrategy.h"
+#include "CompressedPageCache.h"
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <functional>
 
 class BufferManager {
 public:
-    BufferManager(size_t maxPages, const std::string& fileName, std::unique_ptr<ReplacementStrategy> strategy);
+    // secondTier - необязательный второй уровень для вытесненных страниц (сжатые копии в памяти).
+    // Во второй уровень попадают только страницы, к которым обращались повторно, пока они были в буфере;
+    // сжимает их вытеснивший поток после того, как отпустит mutex буфера.
+    BufferManager(size_t maxPages, const std::string& fileName, std::unique_ptr<ReplacementStrategy> strategy,
+        CompressionMode compression = CompressionMode::None, std::unique_ptr<CompressedPageCache> secondTier = nullptr);
 
     Page& getPage(size_t pageIndex);
     void writePage(size_t pageIndex, const Page& page);
     void flushAll();
 
+    // Закреплённая страница не вытесняется, пока не вызван unpinPage.
+    // Используется при параллельном чтении страниц из нескольких потоков (обычно через PinnedPage).
+    Page& pinPage(size_t pageIndex);
+    void unpinPage(size_t pageIndex);
+
+    size_t allocatePage(); // Новая пустая страница в конце файла
+
+    // Массовая загрузка: reservePages выделяет count подряд идущих индексов, writePagesDirect
+    // пишет страницы по порядку прямо в файл, минуя кадры буфера и стратегию замещения
+    size_t reservePages(size_t count);
+    void writePagesDirect(size_t firstPageIndex, const std::vector<Page>& pages);
+
+    // Защёлка содержимого страницы: читатели берут её разделяемо на время копирования записей,
+    // писатели - монопольно на время изменения. Страница должна быть закреплена,
+    // и нельзя держать две защёлки сразу (одна защёлка обслуживает несколько страниц).
+    std::shared_mutex& getPageLatch(size_t pageIndex);
+    void markDirty(size_t pageIndex); // Страница изменена на месте через pinPage
+
+    // Тёплый перезапуск (см. WarmRestart): страницы буфера в порядке вытеснения (вместе с метаданными
+    // стратегии замещения), подгрузка страниц только в свободные кадры (без вытеснения и без учёта
+    // в попаданиях и промахах) и восстановление порядка и метаданных. Восстанавливаются только страницы,
+    // загруженные prefetchPages и с тех пор не запрошенные: запрошенные во время загрузки остаются на своих местах
+    std::vector<size_t> getResidentPages();
+    ReplacementSnapshot getReplacementSnapshot();
+    size_t prefetchPages(const std::vector<size_t>& pageIndices); // Возвращает число загруженных страниц
+    void restoreReplacementSnapshot(const ReplacementSnapshot& snapshot);
+
+    const CompressionStats& getCompressionStats() const;
+    CompressedCacheStats getSecondTierStats(); // Пустая статистика, если второго уровня нет
+
+    // Попадания и промахи getPage/pinPage
+    size_t getHitCount();
+    size_t getMissCount();
+    std::string getReplacementPolicy(); // Описание текущей стратегии замещения
+
+    void setLogging(bool enabled); // Сообщения о вытеснении, чтении и записи страниц (включены по умолчанию)
+
 private:
     struct Frame {
         Page page;
-        bool isDirty; //      
+        bool isDirty; // Нужно ли записать страницу на диск
+        size_t pinCount = 0; // Сколько потоков сейчас используют страницу
+        bool reused = false; // Были обращения после загрузки
+        bool prefetched = false; // Загружена prefetchPages, обращений ещё не было
     };
 
-    std::unique_ptr<ReplacementStrategy> replacementStrategy_; //  
+    // Вытесненная страница, ожидающая сжатия во второй уровень
+    struct Admission {
+        size_t pageIndex;
+        Page page;
+        uint64_t ticket;
+    };
+
+    std::unique_ptr<ReplacementStrategy> replacementStrategy_; // Стратегия замещения
 
-    size_t maxPages_;                              //     
-    std::unordered_map<size_t, Frame> frames_;     //    
+    size_t maxPages_;                              // Максимальное количество страниц в буфере
+    std::unordered_map<size_t, Frame> frames_;     // Храним страницы в памяти
     FileManager fileManager_;
+    std::unique_ptr<CompressedPageCache> secondTier_; // Может отсутствовать
+    std::vector<Admission> admissions_;            // Ждут сжатия
+    std::unordered_map<size_t, uint64_t> admissionTickets_; // Страница -> билет её последнего вытеснения
+    uint64_t nextTicket_ = 0;
+    bool logging_ = true;
+    size_t nextPageIndex_;                         // Индекс следующей новой страницы
+    size_t hitCount_ = 0;
+    size_t missCount_ = 0;
+    std::mutex mutex_;                             // Защищает frames_, стратегию и файл
+    std::unique_ptr<std::shared_mutex[]> latches_; // Защёлки страниц (по индексу страницы)
+
+    Frame& loadFrame(size_t pageIndex); // Вызывается под mutex_
+    void readFrame(size_t pageIndex, Frame& frame); // Из второго уровня или с диска, под mutex_
+    void evictPage(); // Замещение страниц
+    void dropAdmission(size_t pageIndex); // Страница снова в буфере или перезаписана: ожидающая копия устарела
+    void admitEvicted(); // Сжимает ожидающие страницы во второй уровень, вызывается без mutex_
+};
 
-    void evictPage(); //  
+// Закрепляет страницу на время жизни объекта и открепляет её в деструкторе, в том числе при исключении
+class PinnedPage {
+public:
+    PinnedPage(BufferManager& bufferManager, size_t pageIndex);
+    ~PinnedPage();
+    PinnedPage(const PinnedPage&) = delete;
+    PinnedPage& operator=(const PinnedPage&) = delete;
+
+    const Page& operator*() const;
+    const Page* operator->() const;
+
+    // Чтение без защёлки: вызывающий сам исключает одновременные изменения страницы
+    void read(const std::function<void(const Page&)>& read) const;
+    std::shared_lock<std::shared_mutex> lockShared() const; // Разделяемая защёлка на время копирования записей
+    void modify(const std::function<void(Page&)>& modify); // Под монопольной защёлкой, затем markDirty
+
+private:
+    BufferManager& bufferManager_;
+    size_t pageIndex_;
+    Page& page_;
 };
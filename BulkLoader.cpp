@@ -0,0 +1,328 @@
+#include "BulkLoader.h"
+#include "BPlusTree.h"
+#include <stdexcept>
+#include <algorithm>
+#include <queue>
+#include <charconv>
+#include <chrono>
+
+namespace {
+    const size_t CHUNK_ROWS = 8192; // Строк в одной задаче кодирования
+    const size_t WRITE_BATCH_PAGES = 256; // Страниц, которые собираются в памяти до записи в файл
+}
+
+BulkLoader::BulkLoader(const Table& table, BufferManager& bufferManager, TransactionManager& transactionManager,
+    size_t numThreads, double fillFactor)
+    : table_(table), bufferManager_(bufferManager), transactionManager_(transactionManager),
+    pool_(numThreads), fillFactor_(fillFactor) {
+    if (fillFactor <= 0 || fillFactor > 1) {
+        throw std::invalid_argument("Fill factor must be in (0, 1]");
+    }
+}
+
+size_t BulkLoader::load(const std::vector<Row>& rows) {
+    return loadRows(rows.size(), [&](size_t i) { return rows[i]; });
+}
+
+size_t BulkLoader::loadCsv(std::istream& input, bool hasHeader) {
+    // Строки читаются последовательно, разбор идёт в задачах кодирования
+    std::vector<std::string> lines;
+    std::string line;
+    bool header = hasHeader;
+    while (std::getline(input, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (header) {
+            header = false;
+            continue;
+        }
+        if (!line.empty()) {
+            lines.push_back(std::move(line));
+        }
+    }
+    return loadRows(lines.size(), [&](size_t i) { return parseCsvLine(lines[i]); });
+}
+
+size_t BulkLoader::loadBinary(std::istream& input) {
+    std::vector<std::vector<uint8_t>> records;
+    uint32_t length;
+    while (input.read(reinterpret_cast<char*>(&length), sizeof(length))) {
+        std::vector<uint8_t> record(length);
+        if (!input.read(reinterpret_cast<char*>(record.data()), length)) {
+            throw std::runtime_error("Binary input is truncated.");
+        }
+        records.push_back(std::move(record));
+    }
+    return loadRows(records.size(), [&](size_t i) { return table_.decodeRecord(records[i]); });
+}
+
+void BulkLoader::writeBinaryRecord(std::ostream& output, const std::vector<uint8_t>& record) {
+    uint32_t length = static_cast<uint32_t>(record.size());
+    output.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    output.write(reinterpret_cast<const char*>(record.data()), record.size());
+}
+
+Row BulkLoader::parseCsvLine(const std::string& line) const {
+    // Поля через запятую; в кавычках допускаются запятые, "" означает кавычку
+    std::vector<std::string> fields;
+    fields.reserve(table_.columns.size());
+    std::string field;
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        if (!quoted && c != '"' && c != ',') {
+            // Без кавычек поле копируется целиком до следующей запятой
+            size_t end = std::min(line.find_first_of(",\"", i), line.size());
+            field.append(line, i, end - i);
+            i = end - 1;
+        }
+        else if (quoted) {
+            if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+                field += '"';
+                ++i;
+            }
+            else if (c == '"') {
+                quoted = false;
+            }
+            else {
+                field += c;
+            }
+        }
+        else if (c == '"') {
+            quoted = true;
+        }
+        else {
+            fields.push_back(std::move(field));
+            field.clear();
+        }
+    }
+    fields.push_back(std::move(field));
+
+    if (fields.size() != table_.columns.size()) {
+        throw std::runtime_error("CSV row does not match table schema: " + line);
+    }
+
+    Row row;
+    row.reserve(fields.size());
+    for (size_t i = 0; i < fields.size(); ++i) {
+        if (table_.columns[i].type != "INT") {
+            row.emplace_back(std::move(fields[i]));
+            continue;
+        }
+        const std::string& text = fields[i];
+        int64_t value = 0;
+        auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        size_t parsed = result.ec == std::errc() ? static_cast<size_t>(result.ptr - text.data()) : 0;
+        if (parsed != text.size()) {
+            // Редкие формы вроде "+5" или " 5" разбирает stoll
+            try {
+                value = std::stoll(text, &parsed);
+            }
+            catch (const std::exception&) {
+                parsed = 0;
+            }
+        }
+        if (parsed == 0 || parsed != text.size()) {
+            throw std::runtime_error("Invalid INT value in CSV row: " + line);
+        }
+        row.emplace_back(value);
+    }
+    return row;
+}
+
+bool BulkLoader::itemLess(const Item& left, const Item& right) {
+    if (left.keyPrefix != right.keyPrefix) {
+        return left.keyPrefix < right.keyPrefix;
+    }
+    return left.key < right.key;
+}
+
+std::vector<BulkLoader::Item*> BulkLoader::mergeChunks(std::vector<std::vector<Item>>& chunks) {
+    // Слияние всех пакетов за один проход: в куче по одному текущему элементу каждого пакета.
+    // Попарное слияние перемещало каждую запись log2(число пакетов) раз, здесь записи остаются на месте
+    struct Head {
+        Item* item;
+        size_t chunk;
+        size_t position;
+    };
+    auto greater = [](const Head& left, const Head& right) { return itemLess(*right.item, *left.item); };
+    std::priority_queue<Head, std::vector<Head>, decltype(greater)> heads(greater);
+    size_t total = 0;
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        total += chunks[c].size();
+        if (!chunks[c].empty()) {
+            heads.push({ &chunks[c][0], c, 0 });
+        }
+    }
+
+    std::vector<Item*> order;
+    order.reserve(total);
+    while (!heads.empty()) {
+        Head head = heads.top();
+        heads.pop();
+        order.push_back(head.item);
+        if (++head.position < chunks[head.chunk].size()) {
+            head.item = &chunks[head.chunk][head.position];
+            heads.push(head);
+        }
+    }
+    return order;
+}
+
+size_t BulkLoader::loadRows(size_t rowCount, const std::function<Row(size_t)>& getRow) {
+    stats_ = BulkLoadStats();
+    stats_.rowCount = rowCount;
+    indexRoot_ = INVALID_PAGE;
+    bool hasKey = !table_.primaryKey.empty();
+
+    uint64_t timestamp = transactionManager_.beginWrite();
+    try {
+        // Кодирование и сортировка пакетов
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::vector<Item>> chunks((rowCount + CHUNK_ROWS - 1) / CHUNK_ROWS);
+        std::vector<WorkStealingPool::Task> tasks;
+        for (size_t c = 0; c < chunks.size(); ++c) {
+            tasks.push_back([&, c](size_t) {
+                size_t begin = c * CHUNK_ROWS;
+                size_t end = std::min(begin + CHUNK_ROWS, rowCount);
+                std::vector<Item>& chunk = chunks[c];
+                chunk.reserve(end - begin);
+                for (size_t i = begin; i < end; ++i) {
+                    Row row = getRow(i);
+                    Item item;
+                    // Запись кодируется сразу за заголовком версии, без промежуточного вектора
+                    item.record.reserve(HeapFile::VERSION_HEADER_SIZE + 64);
+                    HeapFile::writeHeader(item.record, { timestamp, INFINITE_TIMESTAMP, INVALID_PAGE, 0 });
+                    table_.encodeRecord(row, item.record);
+                    if (hasKey) {
+                        item.key = BPlusTree::encodeRowKey(table_, row);
+                        for (size_t b = 0; b < 8; ++b) {
+                            item.keyPrefix = (item.keyPrefix << 8) | (b < item.key.size() ? item.key[b] : 0);
+                        }
+                    }
+                    chunk.push_back(std::move(item));
+                }
+                if (hasKey) {
+                    std::sort(chunk.begin(), chunk.end(), itemLess);
+                }
+            });
+        }
+        pool_.run(std::move(tasks));
+        stats_.encodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // Без первичного ключа записи идут в порядке входа
+        start = std::chrono::steady_clock::now();
+        std::vector<Item*> items;
+        if (hasKey) {
+            items = mergeChunks(chunks);
+            for (size_t i = 1; i < items.size(); ++i) {
+                if (!itemLess(*items[i - 1], *items[i])) {
+                    throw std::runtime_error("Duplicate primary key in bulk load.");
+                }
+            }
+        }
+        else {
+            items.reserve(rowCount);
+            for (auto& chunk : chunks) {
+                for (auto& item : chunk) {
+                    items.push_back(&item);
+                }
+            }
+        }
+        stats_.mergeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // Страницы заполняются до fillFactor (остаток места нужен для обновлений) и пишутся пакетами
+        // по WRITE_BATCH_PAGES. Последняя страница пакета ждёт следующего пакета: в ней ссылка на
+        // его первую страницу, номер которой известен только после reservePages.
+        start = std::chrono::steady_clock::now();
+        size_t firstPage = INVALID_PAGE;
+        std::vector<Page> batch;
+        Page pending;
+        size_t pendingIndex = INVALID_PAGE;
+        std::vector<std::vector<uint8_t>> keys;
+        std::vector<RID> rids;   // Для страниц текущего пакета pageIndex - номер в пакете
+        size_t batchRids = 0;    // Сколько RID уже получили настоящий номер страницы
+        auto writeBatch = [&](bool last) {
+            size_t first = bufferManager_.reservePages(batch.size());
+            if (pendingIndex == INVALID_PAGE) {
+                firstPage = first;
+            }
+            else {
+                pending.setNextPage(first);
+                bufferManager_.writePagesDirect(pendingIndex, { pending });
+            }
+            for (size_t i = 0; i + 1 < batch.size(); ++i) {
+                batch[i].setNextPage(first + i + 1);
+            }
+            for (; batchRids < rids.size(); ++batchRids) {
+                rids[batchRids].pageIndex += first;
+            }
+            stats_.pageCount += batch.size();
+            if (!last) {
+                pendingIndex = first + batch.size() - 1;
+                pending = std::move(batch.back());
+                batch.pop_back();
+            }
+            bufferManager_.writePagesDirect(first, batch);
+            batch.clear();
+        };
+
+        // Страницы новые и без удалений, поэтому занятое место считаем сами, не обходя слоты
+        size_t capacity = Page().getFreeSpace() + Page::getRecordOverhead();
+        size_t target = static_cast<size_t>(fillFactor_ * capacity);
+        size_t used = 0;
+        batch.emplace_back();
+        if (hasKey) {
+            keys.reserve(rowCount);
+            rids.reserve(rowCount);
+        }
+        for (Item* item : items) {
+            size_t size = item->record.size() + Page::getRecordOverhead();
+            if (size > capacity) {
+                throw std::runtime_error("Record exceeds page size");
+            }
+            if (used > 0 && used + size > target) {
+                if (batch.size() == WRITE_BATCH_PAGES) {
+                    writeBatch(false);
+                }
+                batch.emplace_back();
+                used = 0;
+            }
+            used += size;
+            size_t slot = batch.back().appendRecord(item->record);
+            std::vector<uint8_t>().swap(item->record);
+            if (hasKey) {
+                keys.push_back(std::move(item->key));
+                rids.push_back({ batch.size() - 1, slot });
+            }
+        }
+        std::vector<Item*>().swap(items);
+        chunks.clear();
+        writeBatch(true);
+        stats_.writeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (hasKey) {
+            start = std::chrono::steady_clock::now();
+            size_t indexStart = bufferManager_.reservePages(0);
+            indexRoot_ = BPlusTree::build(bufferManager_, keys, rids, fillFactor_);
+            stats_.indexPageCount = bufferManager_.reservePages(0) - indexStart;
+            stats_.indexSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        transactionManager_.endWrite(timestamp);
+        return firstPage;
+    }
+    catch (...) {
+        transactionManager_.endWrite(timestamp);
+        throw;
+    }
+}
+
+size_t BulkLoader::getIndexRoot() const {
+    return indexRoot_;
+}
+
+const BulkLoadStats& BulkLoader::getStats() const {
+    return stats_;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <istream>
+#include <functional>
+#include "BufferManager.h"
+#include "TransactionManager.h"
+#include "WorkStealingPool.h"
+#include "HeapFile.h"
+#include "Table.h"
+
+struct BulkLoadStats {
+    size_t rowCount = 0;
+    size_t pageCount = 0;       // Страниц таблицы
+    size_t indexPageCount = 0;  // Страниц B+-дерева первичного ключа
+    double encodeSeconds = 0;   // Разбор, кодирование и сортировка пакетов
+    double mergeSeconds = 0;    // Слияние отсортированных пакетов
+    double writeSeconds = 0;    // Сборка и запись страниц таблицы
+    double indexSeconds = 0;    // Построение B+-дерева
+};
+
+// Массовая загрузка строк в новую таблицу.
+// Строки разбираются и кодируются пакетами в нескольких потоках, каждый пакет сортируется
+// по первичному ключу, затем пакеты за один проход сливаются через кучу (переставляются только указатели). Страницы заполняются до fillFactor и пишутся
+// пакетами прямо в файл, минуя стратегию замещения; записи освобождаются по мере переноса на страницы,
+// так что в памяти одновременно собирается лишь один пакет страниц. Если у таблицы есть первичный ключ,
+// по отсортированным ключам снизу вверх строится B+-дерево.
+// Все строки загрузки получают одну метку времени и становятся видны снимкам одновременно.
+class BulkLoader {
+public:
+    BulkLoader(const Table& table, BufferManager& bufferManager, TransactionManager& transactionManager,
+        size_t numThreads, double fillFactor = 0.9);
+
+    // Возвращают первую страницу новой таблицы (для конструктора HeapFile)
+    size_t load(const std::vector<Row>& rows);
+    size_t loadCsv(std::istream& input, bool hasHeader = true);
+    size_t loadBinary(std::istream& input); // Записи Table::encodeRecord, перед каждой длина 4 байта
+
+    // Запись в формате loadBinary
+    static void writeBinaryRecord(std::ostream& output, const std::vector<uint8_t>& record);
+
+    size_t getIndexRoot() const; // Корень B+-дерева (INVALID_PAGE, если первичного ключа нет)
+    const BulkLoadStats& getStats() const;
+
+private:
+    struct Item {
+        uint64_t keyPrefix = 0;      // Первые 8 байт ключа старшим байтом вперёд: обычно их хватает для сравнения
+        std::vector<uint8_t> key;    // Первичный ключ в кодировке BPlusTree
+        std::vector<uint8_t> record; // Запись с заголовком версии
+    };
+
+    // getRow вызывается одновременно из разных потоков для разных номеров строк
+    size_t loadRows(size_t rowCount, const std::function<Row(size_t)>& getRow);
+    static bool itemLess(const Item& left, const Item& right);
+    std::vector<Item*> mergeChunks(std::vector<std::vector<Item>>& chunks); // Записи в порядке ключа
+    Row parseCsvLine(const std::string& line) const;
+
+    Table table_;
+    BufferManager& bufferManager_;
+    TransactionManager& transactionManager_;
+    WorkStealingPool pool_;
+    double fillFactor_;
+    size_t indexRoot_ = INVALID_PAGE;
+    BulkLoadStats stats_;
+};
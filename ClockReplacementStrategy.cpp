@@ -4,8 +4,12 @@
 
 
 #include "ClockReplacementStrategy.h"
+#include <unordered_map>
+#include <algorithm>
+#include <stdexcept>
 
-ClockReplacementStrategy::ClockReplacementStrategy(size_t maxSize) : maxSize_(maxSize) {}
+ClockReplacementStrategy::ClockReplacementStrategy(size_t maxSize, bool referenceOnInsert)
+    : maxSize_(maxSize), referenceOnInsert_(referenceOnInsert) {}
 
 void ClockReplacementStrategy::access(size_t pageIndex) {
     for (auto& entry : clock_) {
@@ -18,21 +22,116 @@ void ClockReplacementStrategy::access(size_t pageIndex) {
 
 void ClockReplacementStrategy::addPage(size_t pageIndex) {
     if (clock_.size() < maxSize_) {
-        clock_.push_back({ pageIndex, true });
+        clock_.push_back({ pageIndex, referenceOnInsert_ });
     }
 }
 
-size_t ClockReplacementStrategy::evict() {
+size_t ClockReplacementStrategy::evict(const std::function<bool(size_t)>& canEvict) {
+    if (std::none_of(clock_.begin(), clock_.end(), [&](const ClockEntry& entry) { return canEvict(entry.pageIndex); })) {
+        throw std::runtime_error("No page can be evicted.");
+    }
     while (true) {
         auto& entry = clock_[clockHand_];
-        if (!entry.referenced) {
-            size_t evictedPage = entry.pageIndex;
-            clock_.erase(clock_.begin() + clockHand_);
-            return evictedPage;
-        }
-        else {
+        // Пропущенная страница сохраняет бит обращения
+        if (canEvict(entry.pageIndex)) {
+            if (!entry.referenced) {
+                size_t evictedPage = entry.pageIndex;
+                clock_.erase(clock_.begin() + clockHand_);
+                if (clockHand_ >= clock_.size()) {
+                    clockHand_ = 0;
+                }
+                return evictedPage;
+            }
             entry.referenced = false;
         }
         clockHand_ = (clockHand_ + 1) % clock_.size();
     }
 }
+
+void ClockReplacementStrategy::removePage(size_t pageIndex) {
+    for (size_t i = 0; i < clock_.size(); ++i) {
+        if (clock_[i].pageIndex == pageIndex) {
+            clock_.erase(clock_.begin() + i);
+            if (i < clockHand_) {
+                --clockHand_;
+            }
+            if (clockHand_ >= clock_.size()) {
+                clockHand_ = 0;
+            }
+            break;
+        }
+    }
+}
+
+void ClockReplacementStrategy::clear() {
+    clock_.clear();
+    clockHand_ = 0;
+}
+
+std::vector<size_t> ClockReplacementStrategy::getEvictionOrder() const {
+    // Стрелка сначала забирает страницы без бита обращения, затем (после сброса битов) остальные
+    std::vector<size_t> pages;
+    for (bool referenced : { false, true }) {
+        for (size_t i = 0; i < clock_.size(); ++i) {
+            const auto& entry = clock_[(clockHand_ + i) % clock_.size()];
+            if (entry.referenced == referenced) {
+                pages.push_back(entry.pageIndex);
+            }
+        }
+    }
+    return pages;
+}
+
+void ClockReplacementStrategy::restoreOrder(const std::vector<size_t>& order) {
+    restoreSnapshot({ order, {}, 0 });
+}
+
+ReplacementSnapshot ClockReplacementStrategy::getSnapshot() const {
+    ReplacementSnapshot snapshot;
+    for (bool referenced : { false, true }) {
+        for (size_t i = 0; i < clock_.size(); ++i) {
+            const auto& entry = clock_[(clockHand_ + i) % clock_.size()];
+            if (entry.referenced == referenced) {
+                snapshot.pages.push_back(entry.pageIndex);
+                snapshot.states.push_back(referenced ? 1 : 0);
+            }
+        }
+    }
+    return snapshot;
+}
+
+void ClockReplacementStrategy::restoreSnapshot(const ReplacementSnapshot& snapshot) {
+    // Перечисленные страницы ставятся сразу за стрелкой. Биты обращения берутся из снимка,
+    // а если их там нет - сохраняются
+    const std::vector<size_t>& order = snapshot.pages;
+    bool hasStates = snapshot.states.size() == order.size();
+    std::unordered_map<size_t, size_t> positions;
+    for (size_t i = 0; i < clock_.size(); ++i) {
+        positions[clock_[i].pageIndex] = i;
+    }
+
+    std::vector<ClockEntry> clock;
+    std::vector<bool> moved(clock_.size(), false);
+    for (size_t i = 0; i < order.size(); ++i) {
+        auto it = positions.find(order[i]);
+        if (it != positions.end() && !moved[it->second]) {
+            moved[it->second] = true;
+            clock.push_back(clock_[it->second]);
+            if (hasStates) {
+                clock.back().referenced = snapshot.states[i] != 0;
+            }
+        }
+    }
+    for (size_t i = 0; i < clock_.size(); ++i) {
+        size_t position = (clockHand_ + i) % clock_.size();
+        if (!moved[position]) {
+            clock.push_back(clock_[position]);
+        }
+    }
+    clock_ = std::move(clock);
+    clockHand_ = 0;
+}
+
+std::string ClockReplacementStrategy::getDescription() const {
+    return referenceOnInsert_ ? "Clock" : "Clock (cold insert)";
+}
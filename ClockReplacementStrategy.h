@@ -8,11 +8,21 @@
 
 class ClockReplacementStrategy : public ReplacementStrategy {
 public:
-    explicit ClockReplacementStrategy(size_t maxSize);
+    // referenceOnInsert = false: новая страница вытесняется первой, если к ней не обратятся
+    // повторно (устойчивость к последовательным просмотрам)
+    explicit ClockReplacementStrategy(size_t maxSize, bool referenceOnInsert = true);
 
     void access(size_t pageIndex) override;
     void addPage(size_t pageIndex) override;
-    size_t evict() override;
+    using ReplacementStrategy::evict;
+    size_t evict(const std::function<bool(size_t)>& canEvict) override;
+    void removePage(size_t pageIndex) override;
+    void clear() override;
+    std::vector<size_t> getEvictionOrder() const override;
+    void restoreOrder(const std::vector<size_t>& order) override;
+    ReplacementSnapshot getSnapshot() const override;            // Вместе с битами обращения
+    void restoreSnapshot(const ReplacementSnapshot& snapshot) override;
+    std::string getDescription() const override;
 
 private:
     struct ClockEntry {
@@ -23,4 +33,5 @@ private:
     std::vector<ClockEntry> clock_;
     size_t clockHand_ = 0;
     size_t maxSize_;
+    bool referenceOnInsert_;
 };
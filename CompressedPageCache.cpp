@@ -0,0 +1,95 @@
+#include "CompressedPageCache.h"
+#include <stdexcept>
+#include <chrono>
+#include <cstring>
+
+CompressedPageCache::CompressedPageCache(size_t budgetBytes, std::unique_ptr<ReplacementStrategy> strategy,
+    CompressionMode mode)
+    : budgetBytes_(budgetBytes), replacementStrategy_(std::move(strategy)), mode_(mode) {
+    if (mode_ == CompressionMode::None) {
+        throw std::invalid_argument("Second buffer tier needs a compression mode");
+    }
+}
+
+std::vector<uint8_t> CompressedPageCache::compress(const Page& page, double& seconds) const {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<uint8_t> data = PageCompressor::compress(page.getData().data(), PAGE_SIZE, mode_);
+    if (data.size() >= PAGE_SIZE) {
+        data = page.getData();
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return data;
+}
+
+void CompressedPageCache::put(size_t pageIndex, std::vector<uint8_t> data, double compressSeconds) {
+    erase(pageIndex);
+    stats_.compressSeconds += compressSeconds;
+
+    if (data.size() > budgetBytes_) {
+        return;
+    }
+    while (stats_.bytesStored + data.size() > budgetBytes_) {
+        auto it = pages_.find(replacementStrategy_->evict());
+        if (it == pages_.end()) {
+            throw std::runtime_error("Page to evict not found in second tier.");
+        }
+        stats_.bytesStored -= it->second.size();
+        pages_.erase(it);
+        ++stats_.evictions;
+    }
+
+    stats_.bytesStored += data.size();
+    pages_[pageIndex] = std::move(data);
+    replacementStrategy_->addPage(pageIndex);
+    stats_.pagesStored = pages_.size();
+}
+
+bool CompressedPageCache::take(size_t pageIndex, Page& page) {
+    auto it = pages_.find(pageIndex);
+    if (it == pages_.end()) {
+        ++stats_.misses;
+        return false;
+    }
+    ++stats_.hits;
+
+    auto start = std::chrono::steady_clock::now();
+    if (it->second.size() == PAGE_SIZE) {
+        std::memcpy(page.getData().data(), it->second.data(), PAGE_SIZE);
+    }
+    else {
+        PageCompressor::decompress(it->second.data(), it->second.size(), page.getData().data(), PAGE_SIZE);
+    }
+    stats_.decompressSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    remove(it);
+    return true;
+}
+
+void CompressedPageCache::erase(size_t pageIndex) {
+    auto it = pages_.find(pageIndex);
+    if (it != pages_.end()) {
+        remove(it);
+    }
+}
+
+void CompressedPageCache::remove(std::unordered_map<size_t, std::vector<uint8_t>>::iterator it) {
+    replacementStrategy_->removePage(it->first);
+    stats_.bytesStored -= it->second.size();
+    pages_.erase(it);
+    stats_.pagesStored = pages_.size();
+}
+
+void CompressedPageCache::clear() {
+    pages_.clear();
+    replacementStrategy_->clear();
+    stats_.bytesStored = 0;
+    stats_.pagesStored = 0;
+}
+
+size_t CompressedPageCache::getBudget() const {
+    return budgetBytes_;
+}
+
+const CompressedCacheStats& CompressedPageCache::getStats() const {
+    return stats_;
+}
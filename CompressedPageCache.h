@@ -0,0 +1,48 @@
+#pragma once
+#include <unordered_map>
+#include <vector>
+#include <memory>
+#include "Page.h"
+#include "PageCompressor.h"
+#include "ReplacementStrategy.h"
+
+// Статистика второго уровня буфера
+struct CompressedCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t pagesStored = 0;     // Страниц сейчас во втором уровне
+    size_t bytesStored = 0;     // Их размер после сжатия
+    size_t evictions = 0;       // Вытеснено из-за нехватки бюджета
+    double compressSeconds = 0;
+    double decompressSeconds = 0;
+};
+
+// Второй уровень буфера: чистые страницы, вытесненные из BufferManager, хранятся в памяти сжатыми.
+// Уровни не пересекаются: при попадании страница распаковывается и уходит из второго уровня в кадр буфера.
+// Бюджет задаётся в байтах сжатых данных; когда новая страница в него не помещается,
+// собственная стратегия замещения выбирает, какие страницы выбросить (их снова придётся читать с диска).
+// Не потокобезопасен: BufferManager вызывает его под своим mutex, кроме compress,
+// который не меняет состояния кэша и выполняется без mutex буфера.
+class CompressedPageCache {
+public:
+    CompressedPageCache(size_t budgetBytes, std::unique_ptr<ReplacementStrategy> strategy,
+        CompressionMode mode = CompressionMode::Fast);
+
+    std::vector<uint8_t> compress(const Page& page, double& seconds) const; // Несжимаемая страница - как есть
+    void put(size_t pageIndex, std::vector<uint8_t> data, double compressSeconds);
+    bool take(size_t pageIndex, Page& page); // При попадании распаковывает страницу и убирает её
+    void erase(size_t pageIndex);            // Копия устарела (страница перезаписана)
+    void clear();
+
+    size_t getBudget() const;
+    const CompressedCacheStats& getStats() const;
+
+private:
+    void remove(std::unordered_map<size_t, std::vector<uint8_t>>::iterator it);
+
+    size_t budgetBytes_;
+    std::unique_ptr<ReplacementStrategy> replacementStrategy_;
+    CompressionMode mode_;
+    std::unordered_map<size_t, std::vector<uint8_t>> pages_; // Сжатые данные (несжимаемые - как есть)
+    CompressedCacheStats stats_;
+};
@@ -2,17 +2,85 @@
 
 
 #include "FIFOReplacementStrategy.h"
+#include <unordered_set>
+#include <stdexcept>
 
 void FIFOReplacementStrategy::access(size_t /*pageIndex*/) {
-    // FIFO   
+    // FIFO не отслеживает доступы
 }
 
 void FIFOReplacementStrategy::addPage(size_t pageIndex) {
     fifoQueue_.push(pageIndex);
 }
 
-size_t FIFOReplacementStrategy::evict() {
-    size_t pageIndex = fifoQueue_.front();
-    fifoQueue_.pop();
+size_t FIFOReplacementStrategy::evict(const std::function<bool(size_t)>& canEvict) {
+    if (!fifoQueue_.empty() && canEvict(fifoQueue_.front())) {
+        size_t pageIndex = fifoQueue_.front();
+        fifoQueue_.pop();
+        return pageIndex;
+    }
+
+    // Пропущенные страницы сохраняют свои места в очереди
+    std::queue<size_t> queue;
+    bool found = false;
+    size_t pageIndex = 0;
+    for (; !fifoQueue_.empty(); fifoQueue_.pop()) {
+        if (!found && canEvict(fifoQueue_.front())) {
+            found = true;
+            pageIndex = fifoQueue_.front();
+        }
+        else {
+            queue.push(fifoQueue_.front());
+        }
+    }
+    fifoQueue_ = std::move(queue);
+    if (!found) {
+        throw std::runtime_error("No page can be evicted.");
+    }
     return pageIndex;
 }
+
+void FIFOReplacementStrategy::removePage(size_t pageIndex) {
+    // Очередь не поддерживает удаление из середины, пересобираем её
+    std::queue<size_t> queue;
+    for (; !fifoQueue_.empty(); fifoQueue_.pop()) {
+        if (fifoQueue_.front() != pageIndex) {
+            queue.push(fifoQueue_.front());
+        }
+    }
+    fifoQueue_ = std::move(queue);
+}
+
+void FIFOReplacementStrategy::clear() {
+    fifoQueue_ = {};
+}
+
+std::vector<size_t> FIFOReplacementStrategy::getEvictionOrder() const {
+    std::vector<size_t> pages;
+    for (std::queue<size_t> queue = fifoQueue_; !queue.empty(); queue.pop()) {
+        pages.push_back(queue.front());
+    }
+    return pages;
+}
+
+void FIFOReplacementStrategy::restoreOrder(const std::vector<size_t>& order) {
+    std::vector<size_t> pages = getEvictionOrder();
+    std::unordered_set<size_t> present(pages.begin(), pages.end());
+    std::unordered_set<size_t> listed;
+
+    fifoQueue_ = {};
+    for (size_t pageIndex : order) {
+        if (present.count(pageIndex) != 0 && listed.insert(pageIndex).second) {
+            fifoQueue_.push(pageIndex);
+        }
+    }
+    for (size_t pageIndex : pages) {
+        if (listed.count(pageIndex) == 0) {
+            fifoQueue_.push(pageIndex);
+        }
+    }
+}
+
+std::string FIFOReplacementStrategy::getDescription() const {
+    return "FIFO";
+}
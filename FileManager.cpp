@@ -1,59 +1,326 @@
 #include "FileManager.h"
 #include <stdexcept>
 #include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+#include <cstring> // Для std::memcpy
 
-FileManager::FileManager(const std::string& fileName) : fileName_(fileName) {
-    //         
+FileManager::FileManager(const std::string& fileName, CompressionMode compression)
+    : fileName_(fileName), compression_(compression) {
+    // Открытие файла в бинарном режиме для чтения и записи
     file_.open(fileName_, std::ios::in | std::ios::out | std::ios::binary);
     if (!file_.is_open()) {
         throw std::runtime_error("Failed to open file.");
     }
+
+    if (compression_ != CompressionMode::None) {
+        loadIndex();
+    }
+}
+
+FileManager::~FileManager() {
+    try {
+        saveIndex();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Failed to save page index: " << e.what() << std::endl;
+    }
 }
 
 void FileManager::writePage(size_t pageIndex, const Page& page) {
-    std::cout << "Writing page " << pageIndex << " to file.\n";
+    if (logging_) {
+        std::cout << "Writing page " << pageIndex << " to file.\n";
+    }
 
     if (!file_.is_open()) {
         throw std::runtime_error("File is not open for writing.");
     }
 
-    size_t offset = pageIndex * PAGE_SIZE;
-    file_.seekp(offset, std::ios::beg);
+    if (compression_ == CompressionMode::None) {
+        size_t offset = pageIndex * PAGE_SIZE;
+        file_.seekp(offset, std::ios::beg);
+
+        if (!file_.good()) {
+            throw std::runtime_error("Failed to seek to position in file.");
+        }
+
+        file_.write(reinterpret_cast<const char*>(page.getData().data()), PAGE_SIZE);
+
+        if (!file_.good()) {
+            throw std::runtime_error("Failed to write page to file.");
+        }
+
+        ++stats_.pagesWritten;
+        stats_.logicalBytes += PAGE_SIZE;
+        stats_.physicalBytes += PAGE_SIZE;
+        if (logging_) {
+            std::cout << "Page " << pageIndex << " successfully written to file.\n";
+        }
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    CompressionMode mode = compression_;
+    std::vector<uint8_t> data = PageCompressor::compress(page.getData().data(), PAGE_SIZE, mode);
+    if (data.size() >= PAGE_SIZE) {
+        // Несжимаемая страница хранится как есть
+        mode = CompressionMode::None;
+        data = page.getData();
+    }
+    stats_.compressSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint16_t size = static_cast<uint16_t>(data.size());
+    uint16_t capacity = static_cast<uint16_t>((data.size() + EXTENT_UNIT - 1) / EXTENT_UNIT * EXTENT_UNIT);
 
+    // На месте перезаписывается только экстент, которого ещё нет в сохранённой карте:
+    // иначе после сбоя карта описывала бы старый размер и режим поверх новых данных
+    auto it = pageIndex_.find(pageIndex);
+    if (it == pageIndex_.end() || it->second.saved || it->second.capacity < size) {
+        if (it != pageIndex_.end() && it->second.saved) {
+            pendingExtents_.emplace_back(it->second.offset, it->second.capacity);
+        }
+        else if (it != pageIndex_.end()) {
+            freeExtents_[it->second.capacity].push_back(it->second.offset);
+        }
+        Extent extent = { allocateExtent(capacity), size, capacity, mode, false };
+        it = pageIndex_.insert_or_assign(pageIndex, extent).first;
+    }
+    it->second.size = size;
+    it->second.mode = mode;
+    indexDirty_ = true;
+
+    file_.seekp(it->second.offset, std::ios::beg);
     if (!file_.good()) {
         throw std::runtime_error("Failed to seek to position in file.");
     }
 
-    file_.write(reinterpret_cast<const char*>(page.getData().data()), PAGE_SIZE);
+    file_.write(reinterpret_cast<const char*>(data.data()), size);
 
     if (!file_.good()) {
         throw std::runtime_error("Failed to write page to file.");
     }
 
-    std::cout << "Page " << pageIndex << " successfully written to file.\n";
+    ++stats_.pagesWritten;
+    stats_.logicalBytes += PAGE_SIZE;
+    stats_.physicalBytes += size;
+    if (logging_) {
+        std::cout << "Page " << pageIndex << " successfully written to file (" << size << " bytes).\n";
+    }
 }
 
 Page FileManager::readPage(size_t pageIndex) {
-    std::cout << "Reading page " << pageIndex << " from file.\n";
+    Page page;
+    readPage(pageIndex, page);
+    return page;
+}
+
+void FileManager::readPage(size_t pageIndex, Page& page) {
+    if (logging_) {
+        std::cout << "Reading page " << pageIndex << " from file.\n";
+    }
 
     if (!file_.is_open()) {
         throw std::runtime_error("File is not open for reading.");
     }
 
-    size_t offset = pageIndex * PAGE_SIZE;
-    file_.seekg(offset, std::ios::beg);
+    if (compression_ == CompressionMode::None) {
+        size_t offset = pageIndex * PAGE_SIZE;
+        file_.seekg(offset, std::ios::beg);
+
+        if (!file_.good()) {
+            throw std::runtime_error("Failed to seek to position in file.");
+        }
+
+        file_.read(reinterpret_cast<char*>(page.getData().data()), PAGE_SIZE);
+
+        if (!file_.good()) {
+            throw std::runtime_error("Failed to read page from file.");
+        }
+
+        ++stats_.pagesRead;
+        if (logging_) {
+            std::cout << "Page " << pageIndex << " successfully read from file.\n";
+        }
+        return;
+    }
+
+    auto it = pageIndex_.find(pageIndex);
+    if (it == pageIndex_.end()) {
+        throw std::runtime_error("Page not found in page index.");
+    }
+    const Extent& extent = it->second;
 
+    file_.seekg(extent.offset, std::ios::beg);
     if (!file_.good()) {
         throw std::runtime_error("Failed to seek to position in file.");
     }
 
-    Page page;
-    file_.read(reinterpret_cast<char*>(page.getData().data()), PAGE_SIZE);
+    std::vector<uint8_t> data(extent.size);
+    file_.read(reinterpret_cast<char*>(data.data()), extent.size);
 
     if (!file_.good()) {
         throw std::runtime_error("Failed to read page from file.");
     }
 
-    std::cout << "Page " << pageIndex << " successfully read from file.\n";
-    return page;
+    // Распаковка сразу в данные страницы
+    auto start = std::chrono::steady_clock::now();
+    if (extent.mode == CompressionMode::None) {
+        if (extent.size != PAGE_SIZE) {
+            throw std::runtime_error("Corrupted page index entry.");
+        }
+        std::memcpy(page.getData().data(), data.data(), PAGE_SIZE);
+    }
+    else {
+        PageCompressor::decompress(data.data(), data.size(), page.getData().data(), PAGE_SIZE);
+    }
+    stats_.decompressSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    ++stats_.pagesRead;
+    if (logging_) {
+        std::cout << "Page " << pageIndex << " successfully read from file.\n";
+    }
+}
+
+void FileManager::setLogging(bool enabled) {
+    logging_ = enabled;
+}
+
+size_t FileManager::getPageCount() {
+    if (!file_.is_open()) {
+        throw std::runtime_error("File is not open.");
+    }
+
+    if (compression_ != CompressionMode::None) {
+        size_t pageCount = 0;
+        for (const auto& entry : pageIndex_) {
+            pageCount = std::max(pageCount, entry.first + 1);
+        }
+        return pageCount;
+    }
+
+    file_.seekg(0, std::ios::end);
+    std::streamoff fileSize = file_.tellg();
+
+    if (!file_.good()) {
+        throw std::runtime_error("Failed to determine file size.");
+    }
+
+    return static_cast<size_t>(fileSize) / PAGE_SIZE;
+}
+
+CompressionMode FileManager::getCompression() const {
+    return compression_;
+}
+
+const CompressionStats& FileManager::getStats() const {
+    return stats_;
+}
+
+size_t FileManager::allocateExtent(uint16_t capacity) {
+    auto it = freeExtents_.lower_bound(capacity);
+    if (it != freeExtents_.end()) {
+        uint16_t freeCapacity = it->first;
+        size_t offset = it->second.back();
+        it->second.pop_back();
+        if (it->second.empty()) {
+            freeExtents_.erase(it);
+        }
+        // Остаток большего экстента остаётся свободным
+        if (freeCapacity > capacity) {
+            freeExtents_[freeCapacity - capacity].push_back(offset + capacity);
+        }
+        return offset;
+    }
+
+    size_t offset = fileEnd_;
+    fileEnd_ += capacity;
+    return offset;
+}
+
+void FileManager::saveIndex() {
+    if (compression_ == CompressionMode::None || !indexDirty_) {
+        return;
+    }
+
+    // Карта не должна ссылаться на данные, которых ещё нет в файле
+    file_.flush();
+
+    std::ofstream indexFile(fileName_ + ".map", std::ios::binary | std::ios::trunc);
+    if (!indexFile.is_open()) {
+        throw std::runtime_error("Failed to open page index for writing.");
+    }
+
+    uint64_t count = pageIndex_.size();
+    indexFile.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    for (const auto& entry : pageIndex_) {
+        uint64_t pageIndex = entry.first;
+        uint64_t offset = entry.second.offset;
+        indexFile.write(reinterpret_cast<const char*>(&pageIndex), sizeof(pageIndex));
+        indexFile.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+        indexFile.write(reinterpret_cast<const char*>(&entry.second.size), sizeof(entry.second.size));
+        indexFile.write(reinterpret_cast<const char*>(&entry.second.capacity), sizeof(entry.second.capacity));
+        indexFile.write(reinterpret_cast<const char*>(&entry.second.mode), sizeof(entry.second.mode));
+    }
+
+    indexFile.flush();
+    if (!indexFile.good()) {
+        throw std::runtime_error("Failed to write page index.");
+    }
+    indexDirty_ = false;
+    for (auto& entry : pageIndex_) {
+        entry.second.saved = true;
+    }
+
+    // Карта больше не ссылается на старые места перенесённых страниц
+    for (const auto& extent : pendingExtents_) {
+        freeExtents_[extent.second].push_back(extent.first);
+    }
+    pendingExtents_.clear();
+}
+
+void FileManager::loadIndex() {
+    std::string indexName = fileName_ + ".map";
+    if (!std::filesystem::exists(indexName)) {
+        if (std::filesystem::file_size(fileName_) > 0) {
+            throw std::runtime_error("Data file has no page index for compressed storage.");
+        }
+        return;
+    }
+
+    std::ifstream indexFile(indexName, std::ios::binary);
+    uint64_t count = 0;
+    indexFile.read(reinterpret_cast<char*>(&count), sizeof(count));
+    for (uint64_t i = 0; i < count && indexFile.good(); ++i) {
+        uint64_t pageIndex = 0;
+        uint64_t offset = 0;
+        Extent extent = {};
+        indexFile.read(reinterpret_cast<char*>(&pageIndex), sizeof(pageIndex));
+        indexFile.read(reinterpret_cast<char*>(&offset), sizeof(offset));
+        indexFile.read(reinterpret_cast<char*>(&extent.size), sizeof(extent.size));
+        indexFile.read(reinterpret_cast<char*>(&extent.capacity), sizeof(extent.capacity));
+        indexFile.read(reinterpret_cast<char*>(&extent.mode), sizeof(extent.mode));
+        extent.offset = static_cast<size_t>(offset);
+        extent.saved = true;
+        pageIndex_[static_cast<size_t>(pageIndex)] = extent;
+    }
+
+    if (!indexFile.good()) {
+        throw std::runtime_error("Failed to read page index.");
+    }
+
+    // Промежутки между занятыми экстентами снова становятся свободными
+    std::vector<std::pair<size_t, size_t>> used;
+    for (const auto& entry : pageIndex_) {
+        used.emplace_back(entry.second.offset, entry.second.capacity);
+    }
+    std::sort(used.begin(), used.end());
+    for (const auto& extent : used) {
+        for (size_t gap = extent.first - fileEnd_; gap > 0; ) {
+            uint16_t capacity = static_cast<uint16_t>(std::min(gap, PAGE_SIZE));
+            freeExtents_[capacity].push_back(extent.first - gap);
+            gap -= capacity;
+        }
+        fileEnd_ = extent.first + extent.second;
+    }
 }
@@ -3,17 +3,68 @@
 
 #include <fstream>
 #include <string>
+#include <map>
+#include <unordered_map>
+#include <vector>
 #include "Page.h"
+#include "PageCompressor.h"
 
+const size_t EXTENT_UNIT = 256; // Шаг размера экстента для сжатых страниц
+
+// Статистика сжатия страниц
+struct CompressionStats {
+    size_t pagesWritten = 0;
+    size_t pagesRead = 0;
+    size_t logicalBytes = 0;     // Размер записанных страниц без сжатия
+    size_t physicalBytes = 0;    // Размер после сжатия
+    double compressSeconds = 0;  // Время сжатия при записи
+    double decompressSeconds = 0; // Время распаковки при чтении
+};
+
+// При включённом сжатии файл - это набор экстентов переменного размера (кратных EXTENT_UNIT),
+// а положение каждой логической страницы хранится в карте страниц в файле "<fileName>.map".
+// Экстент, на который указывает сохранённая карта, не перезаписывается до следующего saveIndex:
+// новая версия страницы пишется в другой экстент, а старый освобождается после сохранения карты.
+// Экстент, выделенный после последнего saveIndex, перезаписывается на месте, если страница в него помещается.
 class FileManager {
 public:
-    FileManager(const std::string& fileName);
+    FileManager(const std::string& fileName, CompressionMode compression = CompressionMode::None);
+    ~FileManager();
+
     void writePage(size_t pageIndex, const Page& page);
     Page readPage(size_t pageIndex);
+    void readPage(size_t pageIndex, Page& page); // Чтение прямо в существующую страницу (кадр буфера)
+    size_t getPageCount(); // Количество страниц в файле
+
+    void saveIndex(); // Сохраняет карту страниц (при сжатии)
+    CompressionMode getCompression() const;
+    const CompressionStats& getStats() const;
+    void setLogging(bool enabled); // Сообщения о чтении и записи страниц
 
 private:
-    std::string fileName_;   //  
-    std::fstream file_;      //     
+    // Положение сжатой страницы в файле
+    struct Extent {
+        size_t offset;
+        uint16_t size;      // Размер сжатых данных
+        uint16_t capacity;  // Выделенное место
+        CompressionMode mode;
+        bool saved;         // Записан в файл карты (в файл не сохраняется)
+    };
+
+    std::string fileName_;   // Имя файла
+    std::fstream file_;      // Член для работы с файлом
+
+    CompressionMode compression_;
+    std::unordered_map<size_t, Extent> pageIndex_;            // Логическая страница -> экстент
+    std::map<uint16_t, std::vector<size_t>> freeExtents_;     // Свободные экстенты по размеру
+    std::vector<std::pair<size_t, uint16_t>> pendingExtents_; // Освобождены, но ещё есть в сохранённой карте
+    size_t fileEnd_ = 0;                                      // Конец занятой части файла
+    bool indexDirty_ = false;
+    bool logging_ = true;
+    CompressionStats stats_;
+
+    void loadIndex();
+    size_t allocateExtent(uint16_t capacity); // Наименьший подходящий свободный экстент или конец файла
 };
 
 #endif // FILEMANAGER_H
@@ -0,0 +1,64 @@
+#include "GarbageCollector.h"
+#include <algorithm>
+#include <stdexcept>
+
+GarbageCollector::GarbageCollector(std::chrono::milliseconds interval)
+    : interval_(interval) {
+    thread_ = std::thread(&GarbageCollector::run, this);
+}
+
+GarbageCollector::~GarbageCollector() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    stopCondition_.notify_all();
+    thread_.join();
+}
+
+void GarbageCollector::addHeapFile(HeapFile& heapFile) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    heapFiles_.push_back(&heapFile);
+}
+
+void GarbageCollector::removeHeapFile(HeapFile& heapFile) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    heapFiles_.erase(std::remove(heapFiles_.begin(), heapFiles_.end(), &heapFile), heapFiles_.end());
+}
+
+void GarbageCollector::collectNow() {
+    // Список таблиц защищён mutex_, поэтому removeHeapFile дожидается конца прохода
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (HeapFile* heapFile : heapFiles_) {
+        collected_ += heapFile->collectGarbage();
+    }
+}
+
+size_t GarbageCollector::getCollectedCount() const {
+    return collected_;
+}
+
+size_t GarbageCollector::getErrorCount() const {
+    return errors_;
+}
+
+std::string GarbageCollector::getLastError() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastError_;
+}
+
+void GarbageCollector::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopCondition_.wait_for(lock, interval_, [this]() { return stop_; })) {
+        for (HeapFile* heapFile : heapFiles_) {
+            try {
+                collected_ += heapFile->collectGarbage();
+            }
+            catch (const std::exception& e) {
+                // Исключение из потока вызвало бы std::terminate; таблица будет обработана на следующем шаге
+                lastError_ = e.what();
+                ++errors_;
+            }
+        }
+    }
+}
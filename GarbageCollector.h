@@ -0,0 +1,42 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include "HeapFile.h"
+
+// Фоновый поток, который периодически удаляет из таблиц версии, не видимые ни одному снимку.
+// Ошибка прохода по таблице не останавливает поток: она учитывается, и таблица обрабатывается на следующем шаге.
+class GarbageCollector {
+public:
+    explicit GarbageCollector(std::chrono::milliseconds interval);
+    ~GarbageCollector(); // Останавливает поток
+
+    GarbageCollector(const GarbageCollector&) = delete;
+    GarbageCollector& operator=(const GarbageCollector&) = delete;
+
+    // Таблица должна жить, пока её не уберут из сборщика или он не остановлен
+    void addHeapFile(HeapFile& heapFile);
+    void removeHeapFile(HeapFile& heapFile);
+
+    void collectNow(); // Один проход по всем таблицам в вызывающем потоке (ошибки пробрасываются)
+    size_t getCollectedCount() const;
+    size_t getErrorCount() const;  // Ошибки фонового потока
+    std::string getLastError();    // Текст последней из них
+
+private:
+    void run();
+
+    std::chrono::milliseconds interval_;
+    std::vector<HeapFile*> heapFiles_;
+    std::mutex mutex_;
+    std::condition_variable stopCondition_;
+    bool stop_ = false;
+    std::atomic<size_t> collected_{ 0 };
+    std::atomic<size_t> errors_{ 0 };
+    std::string lastError_;        // Защищён mutex_
+    std::thread thread_;
+};
@@ -0,0 +1,422 @@
+#include "HashIndex.h"
+#include <stdexcept>
+#include <unordered_set>
+#include <set>
+#include <algorithm>
+#include <mutex>
+#include <cstring>
+
+namespace {
+    const char INDEX_MAGIC[4] = { 'H', 'I', 'D', 'X' };
+
+    // Запись мета-страницы: [сигнатура][глобальная глубина][имя колонки]
+    std::vector<uint8_t> encodeMeta(size_t globalDepth, const std::string& columnName) {
+        std::vector<uint8_t> meta(INDEX_MAGIC, INDEX_MAGIC + sizeof(INDEX_MAGIC));
+        meta.push_back(static_cast<uint8_t>(globalDepth));
+        meta.insert(meta.end(), columnName.begin(), columnName.end());
+        return meta;
+    }
+}
+
+HashIndex::HashIndex(const Table& table, const std::string& columnName, BufferManager& bufferManager, size_t metaPageIndex)
+    : table_(table), column_(table.getColumnIndex(columnName)), bufferManager_(bufferManager), metaPageIndex_(metaPageIndex) {
+    size_t directoryPage = INVALID_PAGE;
+    PinnedPage(bufferManager_, metaPageIndex_).read([&](const Page& page) {
+        if (page.getRecordCount() == 0) {
+            throw std::runtime_error("Page is not a hash index");
+        }
+        std::vector<uint8_t> meta = page.getRecord(0);
+        if (meta.size() < sizeof(INDEX_MAGIC) + 1 || std::memcmp(meta.data(), INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) {
+            throw std::runtime_error("Page is not a hash index");
+        }
+        if (std::string(meta.begin() + sizeof(INDEX_MAGIC) + 1, meta.end()) != columnName) {
+            throw std::runtime_error("Hash index is built on another column");
+        }
+        globalDepth_ = meta[sizeof(INDEX_MAGIC)];
+        directoryPage = page.getNextPage();
+    });
+
+    // Каталог читается целиком: дальше поиск обращается только к страницам корзин
+    while (directoryPage != INVALID_PAGE) {
+        directoryPages_.push_back(directoryPage);
+        PinnedPage(bufferManager_, directoryPage).read([&](const Page& page) {
+            std::vector<uint8_t> entries = page.getRecord(0);
+            for (size_t offset = 0; offset + 8 <= entries.size(); offset += 8) {
+                uint64_t bucket;
+                std::memcpy(&bucket, entries.data() + offset, 8);
+                directory_.push_back(static_cast<size_t>(bucket));
+            }
+            directoryPage = page.getNextPage();
+        });
+    }
+    if (directory_.size() != (size_t(1) << globalDepth_)) {
+        throw std::runtime_error("Hash index directory is damaged");
+    }
+
+    bucketCount_ = std::unordered_set<size_t>(directory_.begin(), directory_.end()).size();
+}
+
+HashIndex HashIndex::create(const Table& table, const std::string& columnName, BufferManager& bufferManager) {
+    table.getColumnIndex(columnName); // Бросает исключение, если колонки нет
+
+    size_t metaPageIndex = bufferManager.allocatePage();
+    size_t directoryPageIndex = bufferManager.allocatePage();
+    size_t bucketPageIndex = bufferManager.allocatePage();
+
+    Page bucketPage;
+    bucketPage.insertRecord({ 0 }); // Локальная глубина
+    bufferManager.writePage(bucketPageIndex, bucketPage);
+
+    Page directoryPage;
+    std::vector<uint8_t> entries(8);
+    uint64_t bucket = bucketPageIndex;
+    std::memcpy(entries.data(), &bucket, 8);
+    directoryPage.insertRecord(entries);
+    bufferManager.writePage(directoryPageIndex, directoryPage);
+
+    Page metaPage;
+    metaPage.insertRecord(encodeMeta(0, columnName));
+    metaPage.setNextPage(directoryPageIndex);
+    bufferManager.writePage(metaPageIndex, metaPage);
+
+    return HashIndex(table, columnName, bufferManager, metaPageIndex);
+}
+
+std::vector<uint8_t> HashIndex::encodeKey(const Value& key) const {
+    // Ключ кодируется так же, как колонка в записи таблицы
+    const Column& column = table_.columns[column_];
+    std::vector<uint8_t> bytes;
+    if (column.type == "INT") {
+        if (!std::holds_alternative<int64_t>(key)) {
+            throw std::runtime_error("Key type does not match column " + column.name);
+        }
+        int64_t value = std::get<int64_t>(key);
+        bytes.resize(column.size);
+        std::memcpy(bytes.data(), &value, column.size);
+    }
+    else {
+        if (!std::holds_alternative<std::string>(key)) {
+            throw std::runtime_error("Key type does not match column " + column.name);
+        }
+        const std::string& value = std::get<std::string>(key);
+        if (column.size != 0 && value.size() > column.size) {
+            throw std::runtime_error("Value is too long for column " + column.name);
+        }
+        bytes.assign(value.begin(), value.end());
+        if (column.size != 0) {
+            bytes.resize(column.size, 0);
+        }
+    }
+
+    if (bytes.size() > MAX_KEY_SIZE) {
+        throw std::runtime_error("Key is too long for hash index");
+    }
+    return bytes;
+}
+
+uint64_t HashIndex::hashKey(const std::vector<uint8_t>& key) {
+    // FNV-1a с перемешиванием: каталог использует младшие биты хеша.
+    // Хеш хранится на диске, поэтому не зависит от реализации std::hash.
+    uint64_t hash = 14695981039346656037ULL;
+    for (uint8_t byte : key) {
+        hash ^= byte;
+        hash *= 1099511628211ULL;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+std::vector<uint8_t> HashIndex::encodeEntry(const RID& rid, uint64_t hash, const std::vector<uint8_t>& key) {
+    std::vector<uint8_t> entry(ENTRY_HEADER_SIZE + key.size());
+    uint64_t pageIndex = rid.pageIndex;
+    uint16_t slot = static_cast<uint16_t>(rid.slot);
+    std::memcpy(entry.data(), &pageIndex, 8);
+    std::memcpy(entry.data() + 8, &slot, 2);
+    std::memcpy(entry.data() + 10, &hash, 8);
+    std::copy(key.begin(), key.end(), entry.begin() + ENTRY_HEADER_SIZE);
+    return entry;
+}
+
+uint64_t HashIndex::getEntryHash(const std::vector<uint8_t>& entry) {
+    uint64_t hash;
+    std::memcpy(&hash, entry.data() + 10, 8);
+    return hash;
+}
+
+bool HashIndex::entryMatches(const std::vector<uint8_t>& entry, uint64_t hash, const std::vector<uint8_t>& key) {
+    return entry.size() == ENTRY_HEADER_SIZE + key.size() && getEntryHash(entry) == hash
+        && (key.empty() || std::memcmp(entry.data() + ENTRY_HEADER_SIZE, key.data(), key.size()) == 0);
+}
+
+void HashIndex::resetBucketPage(Page& page, size_t localDepth) {
+    size_t nextPage = page.getNextPage();
+    page = Page();
+    page.setNextPage(nextPage);
+    page.insertRecord({ static_cast<uint8_t>(localDepth) });
+}
+
+size_t HashIndex::getBucketIndex(uint64_t hash) const {
+    return static_cast<size_t>(hash & ((uint64_t(1) << globalDepth_) - 1));
+}
+
+std::vector<RID> HashIndex::find(const Value& key) {
+    std::vector<uint8_t> keyBytes = encodeKey(key);
+    uint64_t hash = hashKey(keyBytes);
+
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<RID> result;
+    for (size_t pageIndex = directory_[getBucketIndex(hash)]; pageIndex != INVALID_PAGE; ) {
+        ++pageReads_;
+        PinnedPage(bufferManager_, pageIndex).read([&](const Page& page) {
+            for (size_t slot = 1; slot < page.getRecordCount(); ++slot) {
+                if (page.isRecordDeleted(slot)) {
+                    continue;
+                }
+                std::vector<uint8_t> entry = page.getRecord(slot);
+                if (entryMatches(entry, hash, keyBytes)) {
+                    uint64_t ridPage;
+                    uint16_t ridSlot;
+                    std::memcpy(&ridPage, entry.data(), 8);
+                    std::memcpy(&ridSlot, entry.data() + 8, 2);
+                    result.push_back({ static_cast<size_t>(ridPage), ridSlot });
+                }
+            }
+            pageIndex = page.getNextPage();
+        });
+    }
+    return result;
+}
+
+bool HashIndex::insertIntoChain(size_t bucket, const std::vector<uint8_t>& entry, size_t& lastPage) {
+    for (size_t pageIndex = bucket; pageIndex != INVALID_PAGE; ) {
+        lastPage = pageIndex;
+        bool fits = false;
+        PinnedPage(bufferManager_, pageIndex).read([&](const Page& page) {
+            fits = page.getFreeSpace() >= entry.size();
+            pageIndex = page.getNextPage();
+        });
+        if (fits) {
+            PinnedPage(bufferManager_, lastPage).modify([&](Page& page) { page.insertRecord(entry); });
+            return true;
+        }
+    }
+    return false;
+}
+
+void HashIndex::insert(const Value& key, const RID& rid) {
+    std::vector<uint8_t> keyBytes = encodeKey(key);
+    uint64_t hash = hashKey(keyBytes);
+    std::vector<uint8_t> entry = encodeEntry(rid, hash, keyBytes);
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    while (true) {
+        size_t bucket = directory_[getBucketIndex(hash)];
+        size_t lastPage = bucket;
+        if (insertIntoChain(bucket, entry, lastPage)) {
+            return;
+        }
+
+        // Корзина заполнена. Деление поможет, если хеши элементов различаются в битах выше локальной глубины.
+        size_t localDepth = 0;
+        bool canSplit = false;
+        uint64_t depthMask = (uint64_t(1) << MAX_GLOBAL_DEPTH) - 1;
+        for (size_t pageIndex = bucket; pageIndex != INVALID_PAGE; ) {
+            PinnedPage(bufferManager_, pageIndex).read([&](const Page& page) {
+                localDepth = page.getRecord(0)[0];
+                for (size_t slot = 1; slot < page.getRecordCount() && !canSplit; ++slot) {
+                    if (!page.isRecordDeleted(slot) && ((getEntryHash(page.getRecord(slot)) ^ hash) & depthMask) != 0) {
+                        canSplit = true;
+                    }
+                }
+                pageIndex = canSplit ? INVALID_PAGE : page.getNextPage();
+            });
+        }
+
+        if (canSplit && localDepth < MAX_GLOBAL_DEPTH) {
+            splitBucket(bucket, localDepth);
+            continue;
+        }
+
+        // Одинаковые хеши: добавляем страницу переполнения в конец цепочки
+        size_t overflowPage = bufferManager_.allocatePage();
+        PinnedPage(bufferManager_, overflowPage).modify([&](Page& page) {
+            resetBucketPage(page, localDepth);
+            page.insertRecord(entry);
+        });
+        PinnedPage(bufferManager_, lastPage).modify([&](Page& page) { page.setNextPage(overflowPage); });
+        return;
+    }
+}
+
+void HashIndex::splitBucket(size_t bucket, size_t localDepth) {
+    if (localDepth == globalDepth_) {
+        // Удваиваем каталог: новая половина ссылается на те же корзины
+        size_t size = directory_.size();
+        directory_.resize(2 * size);
+        std::copy(directory_.begin(), directory_.begin() + size, directory_.begin() + size);
+        ++globalDepth_;
+        saveMeta();
+        saveDirectory(0, (directory_.size() - 1) / DIRECTORY_ENTRIES_PER_PAGE);
+    }
+
+    // Забираем элементы корзины, её страницы очищаются и остаются в цепочке
+    std::vector<std::vector<uint8_t>> entries;
+    for (size_t pageIndex = bucket; pageIndex != INVALID_PAGE; ) {
+        size_t current = pageIndex;
+        PinnedPage(bufferManager_, current).modify([&](Page& page) {
+            for (size_t slot = 1; slot < page.getRecordCount(); ++slot) {
+                if (!page.isRecordDeleted(slot)) {
+                    entries.push_back(page.getRecord(slot));
+                }
+            }
+            pageIndex = page.getNextPage();
+            resetBucketPage(page, localDepth + 1);
+        });
+    }
+
+    size_t newBucket = bufferManager_.allocatePage();
+    PinnedPage(bufferManager_, newBucket).modify([&](Page& page) { resetBucketPage(page, localDepth + 1); });
+
+    // Раскладываем элементы по биту localDepth, заполняя страницы цепочек по порядку
+    size_t targets[2] = { bucket, newBucket };
+    for (const auto& entry : entries) {
+        size_t& target = targets[(getEntryHash(entry) >> localDepth) & 1];
+        while (true) {
+            bool inserted = false;
+            size_t nextPage = INVALID_PAGE;
+            PinnedPage(bufferManager_, target).modify([&](Page& page) {
+                if (page.getFreeSpace() >= entry.size()) {
+                    page.insertRecord(entry);
+                    inserted = true;
+                }
+                nextPage = page.getNextPage();
+            });
+            if (inserted) {
+                break;
+            }
+            if (nextPage == INVALID_PAGE) {
+                nextPage = bufferManager_.allocatePage();
+                PinnedPage(bufferManager_, nextPage).modify([&](Page& page) { resetBucketPage(page, localDepth + 1); });
+                PinnedPage(bufferManager_, target).modify([&](Page& page) { page.setNextPage(nextPage); });
+            }
+            target = nextPage;
+        }
+    }
+
+    // Половина ссылок каталога на старую корзину переходит на новую
+    std::set<size_t> changedPages;
+    for (size_t i = 0; i < directory_.size(); ++i) {
+        if (directory_[i] == bucket && ((i >> localDepth) & 1)) {
+            directory_[i] = newBucket;
+            changedPages.insert(i / DIRECTORY_ENTRIES_PER_PAGE);
+        }
+    }
+    for (size_t page : changedPages) {
+        saveDirectory(page, page);
+    }
+    ++bucketCount_;
+}
+
+void HashIndex::saveMeta() {
+    std::string columnName = table_.columns[column_].name;
+    PinnedPage(bufferManager_, metaPageIndex_).modify([&](Page& page) {
+        size_t nextPage = page.getNextPage();
+        page = Page();
+        page.setNextPage(nextPage);
+        page.insertRecord(encodeMeta(globalDepth_, columnName));
+    });
+}
+
+void HashIndex::saveDirectory(size_t firstPage, size_t lastPage) {
+    // Новые страницы каталога дописываются в конец цепочки
+    while (directoryPages_.size() <= lastPage) {
+        size_t newPage = bufferManager_.allocatePage();
+        size_t linkPage = directoryPages_.empty() ? metaPageIndex_ : directoryPages_.back();
+        PinnedPage(bufferManager_, linkPage).modify([&](Page& page) { page.setNextPage(newPage); });
+        directoryPages_.push_back(newPage);
+    }
+
+    for (size_t i = firstPage; i <= lastPage; ++i) {
+        size_t begin = i * DIRECTORY_ENTRIES_PER_PAGE;
+        size_t end = std::min(begin + DIRECTORY_ENTRIES_PER_PAGE, directory_.size());
+        std::vector<uint8_t> entries((end - begin) * 8);
+        for (size_t j = begin; j < end; ++j) {
+            uint64_t bucket = directory_[j];
+            std::memcpy(entries.data() + (j - begin) * 8, &bucket, 8);
+        }
+        PinnedPage(bufferManager_, directoryPages_[i]).modify([&](Page& page) {
+            size_t nextPage = page.getNextPage();
+            page = Page();
+            page.setNextPage(nextPage);
+            page.insertRecord(entries);
+        });
+    }
+}
+
+bool HashIndex::remove(const Value& key, const RID& rid) {
+    std::vector<uint8_t> keyBytes = encodeKey(key);
+    uint64_t hash = hashKey(keyBytes);
+    std::vector<uint8_t> target = encodeEntry(rid, hash, keyBytes);
+
+    // Пустые страницы переполнения остаются в цепочке и заполняются следующими вставками
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    for (size_t pageIndex = directory_[getBucketIndex(hash)]; pageIndex != INVALID_PAGE; ) {
+        size_t found = 0;
+        size_t current = pageIndex;
+        PinnedPage(bufferManager_, current).read([&](const Page& page) {
+            for (size_t slot = 1; slot < page.getRecordCount() && found == 0; ++slot) {
+                if (!page.isRecordDeleted(slot) && page.getRecord(slot) == target) {
+                    found = slot;
+                }
+            }
+            pageIndex = page.getNextPage();
+        });
+        if (found != 0) {
+            PinnedPage(bufferManager_, current).modify([&](Page& page) { page.deleteRecord(found); });
+            return true;
+        }
+    }
+    return false;
+}
+
+void HashIndex::insertRecord(const std::vector<uint8_t>& record, const RID& rid) {
+    insert(table_.decodeRecord(record)[column_], rid);
+}
+
+bool HashIndex::removeRecord(const std::vector<uint8_t>& record, const RID& rid) {
+    return remove(table_.decodeRecord(record)[column_], rid);
+}
+
+bool HashIndex::keyDiffers(const std::vector<uint8_t>& left, const std::vector<uint8_t>& right) const {
+    return table_.decodeRecord(left)[column_] != table_.decodeRecord(right)[column_];
+}
+
+void HashIndex::build(HeapFile& heapFile) {
+    RID rid;
+    std::vector<uint8_t> record;
+    for (auto it = heapFile.scan(); it.next(rid, record); ) {
+        insertRecord(record, rid);
+    }
+}
+
+size_t HashIndex::getMetaPage() const {
+    return metaPageIndex_;
+}
+
+size_t HashIndex::getGlobalDepth() {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return globalDepth_;
+}
+
+size_t HashIndex::getBucketCount() {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return bucketCount_;
+}
+
+size_t HashIndex::getPageReadCount() const {
+    return pageReads_;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <shared_mutex>
+#include <atomic>
+#include "BufferManager.h"
+#include "HeapFile.h"
+#include "Table.h"
+
+// Вторичный индекс по одной колонке таблицы: расширяемое хеширование на страницах BufferManager.
+//
+// Каталог из 2^globalDepth ссылок на корзины хранится в памяти и на страницах каталога,
+// связанных в цепочку от мета-страницы. Корзина - цепочка страниц: первая запись каждой
+// страницы хранит локальную глубину, остальные - элементы [RID][хеш][ключ].
+// При переполнении делится только одна корзина (каталог удваивается, если её глубина
+// равна глобальной). Ключи с одинаковым хешем разделить нельзя, поэтому для дубликатов
+// корзина растёт страницами переполнения.
+//
+// Поиск читает одну страницу корзины (плюс страницы переполнения, если ключ повторяется часто).
+// Индекс, добавленный в таблицу через HeapFile::addIndex, таблица обновляет сама; мета-страницу,
+// как и первую страницу таблицы, хранит вызывающий код.
+class HashIndex {
+public:
+    // Открывает индекс по его мета-странице
+    HashIndex(const Table& table, const std::string& columnName, BufferManager& bufferManager, size_t metaPageIndex);
+
+    // Создаёт пустой индекс из одной корзины
+    static HashIndex create(const Table& table, const std::string& columnName, BufferManager& bufferManager);
+
+    void insert(const Value& key, const RID& rid);
+    bool remove(const Value& key, const RID& rid); // false, если такого элемента нет
+    std::vector<RID> find(const Value& key);
+
+    // Ключ берётся из закодированной записи таблицы
+    void insertRecord(const std::vector<uint8_t>& record, const RID& rid);
+    bool removeRecord(const std::vector<uint8_t>& record, const RID& rid);
+    bool keyDiffers(const std::vector<uint8_t>& left, const std::vector<uint8_t>& right) const;
+    void build(HeapFile& heapFile); // Добавляет в индекс все записи таблицы
+
+    size_t getMetaPage() const;
+    size_t getGlobalDepth();
+    size_t getBucketCount();
+    size_t getPageReadCount() const; // Сколько страниц корзин прочитано при поиске
+
+private:
+    static const size_t MAX_GLOBAL_DEPTH = 20;          // Дальше корзины растут страницами переполнения
+    static const size_t DIRECTORY_ENTRIES_PER_PAGE = 480;
+    static const size_t MAX_KEY_SIZE = 1024;
+    static const size_t ENTRY_HEADER_SIZE = 18;         // Страница RID 8 байт, слот 2 байта, хеш 8 байт
+
+    std::vector<uint8_t> encodeKey(const Value& key) const;
+    static uint64_t hashKey(const std::vector<uint8_t>& key);
+    static std::vector<uint8_t> encodeEntry(const RID& rid, uint64_t hash, const std::vector<uint8_t>& key);
+    static uint64_t getEntryHash(const std::vector<uint8_t>& entry);
+    static bool entryMatches(const std::vector<uint8_t>& entry, uint64_t hash, const std::vector<uint8_t>& key);
+
+    // Страницы читаются через PinnedPage::read без защёлки: изменения индекса исключены mutex_.
+    // Меняются через PinnedPage::modify - монопольная защёлка нужна против flushAll
+    void resetBucketPage(Page& page, size_t localDepth); // Пустая страница корзины, ссылка на следующую сохраняется
+
+    bool insertIntoChain(size_t bucket, const std::vector<uint8_t>& entry, size_t& lastPage);
+    void splitBucket(size_t bucket, size_t localDepth);
+    void saveMeta();
+    void saveDirectory(size_t firstPage, size_t lastPage); // Страницы каталога [firstPage, lastPage]
+
+    size_t getBucketIndex(uint64_t hash) const;
+
+    Table table_;
+    size_t column_;
+    BufferManager& bufferManager_;
+    size_t metaPageIndex_;
+
+    std::shared_mutex mutex_;           // Поиск - разделяемо, изменения - монопольно
+    size_t globalDepth_;
+    std::vector<size_t> directory_;     // Первая страница корзины для каждого значения младших бит хеша
+    std::vector<size_t> directoryPages_;
+    size_t bucketCount_;
+    std::atomic<size_t> pageReads_{ 0 };
+};
@@ -0,0 +1,752 @@
+#include "HeapFile.h"
+#include "HashIndex.h"
+#include <stdexcept>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <shared_mutex>
+#include <cstring>
+
+namespace {
+    // Номер слота занимает младшие биты prevSlot, флаги версии - два старших
+    const uint16_t SLOT_MASK = 0x3FFF;
+    const int FLAG_SHIFT = 14;
+}
+
+HeapFile::HeapFile(const Table& table, BufferManager& bufferManager, TransactionManager& transactionManager, size_t firstPageIndex)
+    : table_(table), bufferManager_(bufferManager), transactionManager_(transactionManager), firstPageIndex_(firstPageIndex) {
+    // Восстанавливаем порядок страниц по ссылкам в заголовках
+    auto pages = std::make_shared<std::vector<size_t>>();
+    for (size_t pageIndex = firstPageIndex; pageIndex != INVALID_PAGE; ) {
+        pages->push_back(pageIndex);
+        pageIndex = bufferManager_.getPage(pageIndex).getNextPage();
+    }
+    pages_ = pages;
+
+    for (size_t pageIndex = bufferManager_.getPage(firstPageIndex).getVersionPage(); pageIndex != INVALID_PAGE; ) {
+        versionPages_.push_back(pageIndex);
+        pageIndex = bufferManager_.getPage(pageIndex).getNextPage();
+    }
+
+    recover();
+}
+
+HeapFile HeapFile::create(const Table& table, BufferManager& bufferManager, TransactionManager& transactionManager) {
+    size_t firstPageIndex = bufferManager.allocatePage();
+    return HeapFile(table, bufferManager, transactionManager, firstPageIndex);
+}
+
+void HeapFile::recover() {
+    // После открытия старых снимков нет: удалённые записи и старые версии больше не нужны
+    uint64_t maxTimestamp = 0;
+    std::vector<std::pair<RID, RID>> stubs; // Заглушка и место записи
+    std::unordered_set<uint64_t> deletedMoved; // Удалённые перенесённые версии (страница << 16 | слот)
+    for (size_t pageIndex : *pages_) {
+        std::vector<std::pair<size_t, std::vector<uint8_t>>> records;
+        readPageRecords(pageIndex, records);
+
+        std::vector<size_t> deleted;
+        std::vector<std::pair<size_t, std::vector<uint8_t>>> unlinked;
+        for (auto& entry : records) {
+            VersionHeader header = readHeader(entry.second);
+            if (header.flags & FORWARD_FLAG) {
+                stubs.push_back({ { pageIndex, entry.first }, { static_cast<size_t>(header.prevPage), header.prevSlot } });
+                continue;
+            }
+            if ((header.flags & MOVED_FLAG) && header.endTs != INFINITE_TIMESTAMP) {
+                deletedMoved.insert(uint64_t(pageIndex) << 16 | entry.first);
+            }
+            maxTimestamp = std::max(maxTimestamp, header.beginTs);
+            if (header.endTs != INFINITE_TIMESTAMP) {
+                maxTimestamp = std::max(maxTimestamp, header.endTs);
+                deleted.push_back(entry.first);
+            }
+            else if (header.prevPage != INVALID_PAGE) {
+                header.prevPage = INVALID_PAGE;
+                writeHeader(entry.second, header);
+                unlinked.push_back(std::move(entry));
+            }
+        }
+
+        if (!deleted.empty()) {
+            freeSpacePages_.insert(pageIndex);
+        }
+        if (!deleted.empty() || !unlinked.empty()) {
+            PinnedPage(bufferManager_, pageIndex).modify([&](Page& page) {
+                for (size_t slot : deleted) {
+                    page.deleteRecord(slot);
+                }
+                for (const auto& entry : unlinked) {
+                    page.updateRecord(entry.first, entry.second);
+                }
+            });
+        }
+    }
+
+    // Заглушки удалённых записей больше не нужны
+    for (const auto& stub : stubs) {
+        if (deletedMoved.count(uint64_t(stub.second.pageIndex) << 16 | stub.second.slot) != 0) {
+            PinnedPage(bufferManager_, stub.first.pageIndex).modify([&](Page& page) { page.deleteRecord(stub.first.slot); });
+            freeSpacePages_.insert(stub.first.pageIndex);
+        }
+    }
+
+    // Хранилище версий очищается и используется заново
+    for (auto it = versionPages_.rbegin(); it != versionPages_.rend(); ++it) {
+        PinnedPage(bufferManager_, *it).modify([](Page& page) {
+            size_t nextPage = page.getNextPage();
+            page = Page();
+            page.setNextPage(nextPage);
+        });
+        freeVersionPages_.push_back(*it);
+    }
+
+    transactionManager_.advanceTo(maxTimestamp);
+}
+
+HeapFile::VersionHeader HeapFile::readHeader(const std::vector<uint8_t>& record) {
+    if (record.size() < VERSION_HEADER_SIZE) {
+        throw std::runtime_error("Record has no version header");
+    }
+    VersionHeader header;
+    std::memcpy(&header.beginTs, record.data(), 8);
+    std::memcpy(&header.endTs, record.data() + 8, 8);
+    std::memcpy(&header.prevPage, record.data() + 16, 8);
+    uint16_t prevSlot;
+    std::memcpy(&prevSlot, record.data() + 24, 2);
+    header.prevSlot = prevSlot & SLOT_MASK;
+    header.flags = static_cast<uint8_t>(prevSlot >> FLAG_SHIFT);
+    return header;
+}
+
+void HeapFile::writeHeader(std::vector<uint8_t>& record, const VersionHeader& header) {
+    if (record.size() < VERSION_HEADER_SIZE) {
+        record.resize(VERSION_HEADER_SIZE);
+    }
+    std::memcpy(record.data(), &header.beginTs, 8);
+    std::memcpy(record.data() + 8, &header.endTs, 8);
+    std::memcpy(record.data() + 16, &header.prevPage, 8);
+    uint16_t prevSlot = static_cast<uint16_t>(header.prevSlot | (header.flags << FLAG_SHIFT));
+    std::memcpy(record.data() + 24, &prevSlot, 2);
+}
+
+std::vector<uint8_t> HeapFile::readSlot(size_t pageIndex, size_t slot) {
+    PinnedPage page(bufferManager_, pageIndex);
+    auto latch = page.lockShared();
+    return page->getRecord(slot);
+}
+
+std::vector<uint8_t> HeapFile::readNewest(const RID& rid, RID& location) {
+    std::vector<uint8_t> record = readSlot(rid.pageIndex, rid.slot);
+    VersionHeader header = readHeader(record);
+    if (header.flags & FORWARD_FLAG) {
+        location = { static_cast<size_t>(header.prevPage), header.prevSlot };
+        return readSlot(location.pageIndex, location.slot);
+    }
+    location = rid;
+    return record;
+}
+
+void HeapFile::readPageRecords(size_t pageIndex, std::vector<std::pair<size_t, std::vector<uint8_t>>>& records) {
+    PinnedPage page(bufferManager_, pageIndex);
+    auto latch = page.lockShared();
+    for (size_t slot = 0; slot < page->getRecordCount(); ++slot) {
+        if (!page->isRecordDeleted(slot)) {
+            records.emplace_back(slot, page->getRecord(slot));
+        }
+    }
+}
+
+bool HeapFile::findVisible(const std::vector<uint8_t>& newest, uint64_t timestamp, std::vector<uint8_t>& record) {
+    // Идём от новой версии к старым, пока не найдём начавшуюся до снимка.
+    // Старые версии читаются только при необходимости, новейшая не копируется.
+    const std::vector<uint8_t>* version = &newest;
+    std::vector<uint8_t> older;
+    while (true) {
+        VersionHeader header = readHeader(*version);
+        if (header.beginTs <= timestamp) {
+            if (timestamp >= header.endTs) {
+                return false; // Удалена до снимка
+            }
+            record.assign(version->begin() + VERSION_HEADER_SIZE, version->end());
+            return true;
+        }
+        if (header.prevPage == INVALID_PAGE) {
+            return false; // Вставлена после снимка
+        }
+        older = readSlot(header.prevPage, header.prevSlot);
+        version = &older;
+    }
+}
+
+std::shared_ptr<const std::vector<size_t>> HeapFile::getPages() {
+    std::lock_guard<std::mutex> lock(pagesMutex_);
+    return pages_;
+}
+
+RID HeapFile::insertIntoChain(bool versionStore, const std::vector<uint8_t>& record) {
+    auto freeSpace = [this](size_t pageIndex) {
+        return PinnedPage(bufferManager_, pageIndex)->getFreeSpace();
+    };
+
+    size_t targetPage;
+    if (!versionStore) {
+        // Сначала занимаем место, освобождённое удалениями; страница, где запись не поместилась,
+        // выбывает из списка до следующего удаления на ней
+        targetPage = INVALID_PAGE;
+        while (targetPage == INVALID_PAGE && !freeSpacePages_.empty()) {
+            size_t candidate = *freeSpacePages_.begin();
+            if (freeSpace(candidate) >= record.size()) {
+                targetPage = candidate;
+            }
+            else {
+                freeSpacePages_.erase(freeSpacePages_.begin());
+            }
+        }
+
+        // Иначе запись добавляется в последнюю страницу, при нехватке места цепочка удлиняется
+        auto pages = getPages();
+        if (targetPage == INVALID_PAGE) {
+            targetPage = pages->back();
+        }
+        if (targetPage == pages->back() && freeSpace(targetPage) < record.size()) {
+            size_t newPageIndex = bufferManager_.allocatePage();
+            PinnedPage(bufferManager_, targetPage).modify([&](Page& page) { page.setNextPage(newPageIndex); });
+
+            // Начатые просмотры продолжают работать со старым списком
+            auto newPages = std::make_shared<std::vector<size_t>>(*pages);
+            newPages->push_back(newPageIndex);
+            {
+                std::lock_guard<std::mutex> lock(pagesMutex_);
+                pages_ = newPages;
+            }
+            targetPage = newPageIndex;
+        }
+    }
+    else {
+        if (currentVersionPage_ == INVALID_PAGE || freeSpace(currentVersionPage_) < record.size()) {
+            if (!freeVersionPages_.empty()) {
+                currentVersionPage_ = freeVersionPages_.back();
+                freeVersionPages_.pop_back();
+            }
+            else {
+                size_t newPageIndex = bufferManager_.allocatePage();
+                size_t linkPage = versionPages_.empty() ? firstPageIndex_ : versionPages_.back();
+                PinnedPage(bufferManager_, linkPage).modify([&](Page& page) {
+                    if (versionPages_.empty()) {
+                        page.setVersionPage(newPageIndex);
+                    }
+                    else {
+                        page.setNextPage(newPageIndex);
+                    }
+                });
+                versionPages_.push_back(newPageIndex);
+                currentVersionPage_ = newPageIndex;
+            }
+        }
+        targetPage = currentVersionPage_;
+    }
+
+    size_t slot = 0;
+    PinnedPage(bufferManager_, targetPage).modify([&](Page& page) { slot = page.insertRecord(record); });
+    return { targetPage, slot };
+}
+
+RID HeapFile::insertRecord(const std::vector<uint8_t>& record) {
+    static const size_t maxRecordSize = Page().getFreeSpace() - VERSION_HEADER_SIZE;
+    if (record.size() > maxRecordSize) {
+        throw std::runtime_error("Record exceeds page size");
+    }
+
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    uint64_t timestamp = transactionManager_.beginWrite();
+    try {
+        std::vector<uint8_t> versioned(VERSION_HEADER_SIZE);
+        writeHeader(versioned, { timestamp, INFINITE_TIMESTAMP, INVALID_PAGE, 0 });
+        versioned.insert(versioned.end(), record.begin(), record.end());
+
+        RID rid = insertIntoChain(false, versioned);
+        try {
+            addIndexEntries(record, rid);
+        }
+        catch (...) {
+            // Версию ещё не видит ни один снимок, её можно удалить сразу
+            PinnedPage(bufferManager_, rid.pageIndex).modify([&](Page& page) { page.deleteRecord(rid.slot); });
+            throw;
+        }
+        transactionManager_.endWrite(timestamp);
+        return rid;
+    }
+    catch (...) {
+        transactionManager_.endWrite(timestamp);
+        throw;
+    }
+}
+
+std::vector<uint8_t> HeapFile::getRecord(const RID& rid) {
+    auto snapshot = transactionManager_.beginSnapshot();
+    return getRecord(rid, *snapshot);
+}
+
+std::vector<uint8_t> HeapFile::getRecord(const RID& rid, const Snapshot& snapshot) {
+    std::vector<uint8_t> record;
+    RID location;
+    if (!findVisible(readNewest(rid, location), snapshot.getTimestamp(), record)) {
+        throw std::runtime_error("Record is not visible in snapshot");
+    }
+    return record;
+}
+
+void HeapFile::writeNewVersion(const RID& rid, const RID& location, std::vector<uint8_t>& current,
+    const std::vector<uint8_t>& record, uint64_t timestamp) {
+    VersionHeader header = readHeader(current);
+    bool moved = !(location == rid);
+
+    // Страницы таблицы меняют только писатели под writeMutex_, поэтому проверка не устареет
+    size_t newSize = VERSION_HEADER_SIZE + record.size();
+    bool fits;
+    {
+        PinnedPage page(bufferManager_, location.pageIndex);
+        auto latch = page.lockShared();
+        fits = page->canUpdateRecord(location.slot, newSize);
+    }
+
+    std::vector<uint8_t> versioned(VERSION_HEADER_SIZE);
+    versioned.insert(versioned.end(), record.begin(), record.end());
+    if (fits || !moved) {
+        // Старая версия уходит в хранилище версий и живёт до метки изменения
+        VersionHeader copy = header;
+        copy.flags = 0;
+        writeHeader(current, copy);
+        RID previous = insertIntoChain(true, current);
+        writeHeader(versioned, { timestamp, INFINITE_TIMESTAMP, previous.pageIndex,
+            static_cast<uint16_t>(previous.slot), fits && !moved ? uint8_t(0) : MOVED_FLAG });
+        try {
+            if (fits) {
+                // Новая версия остаётся на месте, поэтому RID не меняется
+                PinnedPage(bufferManager_, location.pageIndex).modify([&](Page& page) { page.updateRecord(location.slot, versioned); });
+            }
+            else {
+                // Не помещается: новая версия переносится, в слоте RID остаётся заглушка
+                RID target = insertIntoChain(false, versioned);
+                std::vector<uint8_t> stub(VERSION_HEADER_SIZE);
+                writeHeader(stub, { 0, INFINITE_TIMESTAMP, target.pageIndex, static_cast<uint16_t>(target.slot), FORWARD_FLAG });
+                try {
+                    PinnedPage(bufferManager_, rid.pageIndex).modify([&](Page& page) { page.updateRecord(rid.slot, stub); });
+                }
+                catch (...) {
+                    // Без заглушки перенесённую версию никто не найдёт
+                    PinnedPage(bufferManager_, target.pageIndex).modify([&](Page& page) { page.deleteRecord(target.slot); });
+                    throw;
+                }
+            }
+        }
+        catch (...) {
+            PinnedPage(bufferManager_, previous.pageIndex).modify([&](Page& page) { page.deleteRecord(previous.slot); });
+            throw;
+        }
+    }
+    else {
+        // Уже перенесённая версия не помещается снова: она остаётся на месте как старая версия,
+        // новая переносится дальше, заглушка указывает на неё
+        writeHeader(versioned, { timestamp, INFINITE_TIMESTAMP, location.pageIndex,
+            static_cast<uint16_t>(location.slot), MOVED_FLAG });
+        RID target = insertIntoChain(false, versioned);
+        bool closed = false;
+        try {
+            PinnedPage(bufferManager_, location.pageIndex).modify([&](Page& page) { page.updateRecord(location.slot, current); });
+            closed = true;
+            std::vector<uint8_t> stub(VERSION_HEADER_SIZE);
+            writeHeader(stub, { 0, INFINITE_TIMESTAMP, target.pageIndex, static_cast<uint16_t>(target.slot), FORWARD_FLAG });
+            PinnedPage(bufferManager_, rid.pageIndex).modify([&](Page& page) { page.updateRecord(rid.slot, stub); });
+        }
+        catch (...) {
+            // Заглушка по-прежнему указывает на старую версию: новую удаляем, старую снова делаем новейшей
+            PinnedPage(bufferManager_, target.pageIndex).modify([&](Page& page) { page.deleteRecord(target.slot); });
+            if (closed) {
+                header.endTs = INFINITE_TIMESTAMP;
+                writeHeader(current, header);
+                PinnedPage(bufferManager_, location.pageIndex).modify([&](Page& page) { page.updateRecord(location.slot, current); });
+            }
+            throw;
+        }
+    }
+}
+
+void HeapFile::updateRecord(const RID& rid, const std::vector<uint8_t>& record) {
+    static const size_t maxRecordSize = Page().getFreeSpace() - VERSION_HEADER_SIZE;
+    if (record.size() > maxRecordSize) {
+        throw std::runtime_error("Record exceeds page size");
+    }
+
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    uint64_t timestamp = transactionManager_.beginWrite();
+    try {
+        RID location;
+        std::vector<uint8_t> current = readNewest(rid, location);
+        VersionHeader header = readHeader(current);
+        if (header.endTs != INFINITE_TIMESTAMP) {
+            throw std::runtime_error("Record has been deleted");
+        }
+        header.endTs = timestamp;
+        writeHeader(current, header);
+
+        // Новые ключи добавляются в индексы до изменения записи, старые убираются после
+        std::vector<uint8_t> previousData(current.begin() + VERSION_HEADER_SIZE, current.end());
+        std::vector<HashIndex*> changedIndexes = addIndexEntries(record, rid, &previousData);
+        try {
+            writeNewVersion(rid, location, current, record, timestamp);
+        }
+        catch (...) {
+            removeIndexEntries(changedIndexes, record, rid);
+            throw;
+        }
+        removeIndexEntries(changedIndexes, previousData, rid);
+        garbagePages_.insert(rid.pageIndex);
+
+        transactionManager_.endWrite(timestamp);
+    }
+    catch (...) {
+        transactionManager_.endWrite(timestamp);
+        throw;
+    }
+}
+
+void HeapFile::deleteRecord(const RID& rid) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    uint64_t timestamp = transactionManager_.beginWrite();
+    try {
+        RID location;
+        std::vector<uint8_t> current = readNewest(rid, location);
+        VersionHeader header = readHeader(current);
+        if (header.endTs != INFINITE_TIMESTAMP) {
+            throw std::runtime_error("Record has been deleted");
+        }
+
+        // Слот освободит сборщик мусора, когда запись не будет видна ни одному снимку
+        header.endTs = timestamp;
+        writeHeader(current, header);
+        PinnedPage(bufferManager_, location.pageIndex).modify([&](Page& page) { page.updateRecord(location.slot, current); });
+        garbagePages_.insert(rid.pageIndex);
+        removeIndexEntries(indexes_, std::vector<uint8_t>(current.begin() + VERSION_HEADER_SIZE, current.end()), rid);
+
+        transactionManager_.endWrite(timestamp);
+    }
+    catch (...) {
+        transactionManager_.endWrite(timestamp);
+        throw;
+    }
+}
+
+void HeapFile::addIndex(HashIndex& index, bool fill) {
+    // Писатели ждут, пока индекс заполняется, поэтому ни одно изменение не пропадёт
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    if (fill) {
+        index.build(*this);
+    }
+    indexes_.push_back(&index);
+}
+
+void HeapFile::removeIndex(HashIndex& index) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    indexes_.erase(std::remove(indexes_.begin(), indexes_.end(), &index), indexes_.end());
+}
+
+std::vector<HashIndex*> HeapFile::addIndexEntries(const std::vector<uint8_t>& record, const RID& rid,
+    const std::vector<uint8_t>* previous) {
+    std::vector<HashIndex*> changed;
+    try {
+        for (HashIndex* index : indexes_) {
+            if (previous == nullptr || index->keyDiffers(*previous, record)) {
+                index->insertRecord(record, rid);
+                changed.push_back(index);
+            }
+        }
+    }
+    catch (...) {
+        removeIndexEntries(changed, record, rid);
+        throw;
+    }
+    return changed;
+}
+
+void HeapFile::removeIndexEntries(const std::vector<HashIndex*>& indexes, const std::vector<uint8_t>& record, const RID& rid) {
+    for (HashIndex* index : indexes) {
+        index->removeRecord(record, rid);
+    }
+}
+
+size_t HeapFile::deleteVersionChain(size_t pageIndex, size_t slot) {
+    size_t removed = 0;
+    while (pageIndex != INVALID_PAGE) {
+        VersionHeader header = readHeader(readSlot(pageIndex, slot));
+        bool empty = false;
+        PinnedPage(bufferManager_, pageIndex).modify([&](Page& page) {
+            page.deleteRecord(slot);
+            empty = page.getRecordCount() == 0;
+        });
+        ++removed;
+
+        // Перенесённые версии лежат в страницах таблицы: их место достаётся новым записям.
+        // Опустевшая страница хранилища снова доступна для копий
+        if (std::find(versionPages_.begin(), versionPages_.end(), pageIndex) == versionPages_.end()) {
+            freeSpacePages_.insert(pageIndex);
+        }
+        else if (empty && pageIndex != currentVersionPage_
+            && std::find(freeVersionPages_.begin(), freeVersionPages_.end(), pageIndex) == freeVersionPages_.end()) {
+            freeVersionPages_.push_back(pageIndex);
+        }
+
+        pageIndex = header.prevPage;
+        slot = header.prevSlot;
+    }
+    return removed;
+}
+
+size_t HeapFile::collectPageGarbage(size_t pageIndex, uint64_t oldest, bool& pending) {
+    std::vector<std::pair<size_t, std::vector<uint8_t>>> records;
+    readPageRecords(pageIndex, records);
+
+    size_t removed = 0;
+    for (auto& entry : records) {
+        VersionHeader home = readHeader(entry.second);
+
+        // Перенесённые версии обрабатываются через заглушку. Здесь удаляются только версии,
+        // оставшиеся от удалённых записей (beginTs == endTs): их уже не видит ни один снимок
+        if (home.flags & MOVED_FLAG) {
+            if (home.beginTs == home.endTs && home.endTs <= oldest) {
+                PinnedPage(bufferManager_, pageIndex).modify([&](Page& page) { page.deleteRecord(entry.first); });
+                freeSpacePages_.insert(pageIndex);
+                ++removed;
+            }
+            else if (home.beginTs == home.endTs) {
+                pending = true;
+            }
+            continue;
+        }
+
+        // Новейшая версия записи: в слоте RID или там, куда указывает заглушка
+        size_t headPage = pageIndex;
+        size_t headSlot = entry.first;
+        std::vector<uint8_t> head = entry.second;
+        if (home.flags & FORWARD_FLAG) {
+            headPage = static_cast<size_t>(home.prevPage);
+            headSlot = home.prevSlot;
+            head = readSlot(headPage, headSlot);
+            home = readHeader(head);
+
+            if (home.endTs != INFINITE_TIMESTAMP && home.endTs <= oldest) {
+                // Заглушка удаляется сразу, а перенесённая версия - только когда закончатся снимки,
+                // которые могли успеть прочитать заглушку: метка beginTs == endTs делает её невидимой
+                if (home.prevPage != INVALID_PAGE) {
+                    removed += deleteVersionChain(static_cast<size_t>(home.prevPage), home.prevSlot);
+                }
+                uint64_t timestamp = transactionManager_.beginWrite();
+                head.resize(VERSION_HEADER_SIZE);
+                writeHeader(head, { timestamp, timestamp, INVALID_PAGE, 0, MOVED_FLAG });
+                PinnedPage(bufferManager_, headPage).modify([&](Page& page) { page.updateRecord(headSlot, head); });
+                PinnedPage(bufferManager_, pageIndex).modify([&](Page& page) { page.deleteRecord(entry.first); });
+                freeSpacePages_.insert(pageIndex);
+                transactionManager_.endWrite(timestamp);
+                ++removed;
+
+                if (headPage == pageIndex) {
+                    pending = true;
+                }
+                else {
+                    garbagePages_.insert(headPage);
+                }
+                continue;
+            }
+        }
+        else if (home.endTs != INFINITE_TIMESTAMP && home.endTs <= oldest) {
+            // Запись удалена до самого старого снимка: удаляем её вместе со всеми версиями
+            removed += deleteVersionChain(pageIndex, entry.first);
+            continue;
+        }
+
+        // Находим версию, видимую самому старому снимку; все версии старше неё не нужны
+        size_t versionPage = headPage;
+        size_t versionSlot = headSlot;
+        std::vector<uint8_t> version = head;
+        VersionHeader header = home;
+        while (header.beginTs > oldest && header.prevPage != INVALID_PAGE) {
+            versionPage = header.prevPage;
+            versionSlot = header.prevSlot;
+            version = readSlot(versionPage, versionSlot);
+            header = readHeader(version);
+        }
+
+        if (header.beginTs <= oldest && header.prevPage != INVALID_PAGE) {
+            size_t prevPage = header.prevPage;
+            size_t prevSlot = header.prevSlot;
+            header.prevPage = INVALID_PAGE;
+            header.prevSlot = 0;
+            writeHeader(version, header);
+            PinnedPage(bufferManager_, versionPage).modify([&](Page& page) { page.updateRecord(versionSlot, version); });
+            removed += deleteVersionChain(prevPage, prevSlot);
+
+            if (versionPage == headPage && versionSlot == headSlot) {
+                home = header;
+            }
+        }
+
+        if (home.prevPage != INVALID_PAGE || home.endTs != INFINITE_TIMESTAMP) {
+            pending = true;
+        }
+    }
+    return removed;
+}
+
+size_t HeapFile::collectGarbage() {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    uint64_t oldest = transactionManager_.getOldestSnapshot();
+
+    size_t removed = 0;
+    std::vector<size_t> pages(garbagePages_.begin(), garbagePages_.end());
+    for (size_t pageIndex : pages) {
+        bool pending = false;
+        removed += collectPageGarbage(pageIndex, oldest, pending);
+        if (!pending) {
+            garbagePages_.erase(pageIndex);
+        }
+    }
+    return removed;
+}
+
+const Table& HeapFile::getTable() const {
+    return table_;
+}
+
+size_t HeapFile::getFirstPage() const {
+    return firstPageIndex_;
+}
+
+size_t HeapFile::getPageCount() {
+    return getPages()->size();
+}
+
+size_t HeapFile::getVersionPageCount() {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    return versionPages_.size();
+}
+
+TransactionManager& HeapFile::getTransactionManager() const {
+    return transactionManager_;
+}
+
+HeapFile::ScanIterator HeapFile::scan() {
+    return scan(transactionManager_.beginSnapshot());
+}
+
+HeapFile::ScanIterator HeapFile::scan(std::shared_ptr<const Snapshot> snapshot) {
+    auto pages = getPages();
+    return ScanIterator(*this, pages, std::move(snapshot), 0, pages->size());
+}
+
+HeapFile::ScanIterator HeapFile::scanRange(std::shared_ptr<const Snapshot> snapshot, size_t beginPage, size_t endPage) {
+    auto pages = getPages();
+    if (beginPage > endPage || endPage > pages->size()) {
+        throw std::out_of_range("Invalid page range");
+    }
+    return ScanIterator(*this, pages, std::move(snapshot), beginPage, endPage);
+}
+
+std::vector<HeapFile::ScanIterator> HeapFile::morsels(size_t pagesPerMorsel) {
+    return morsels(transactionManager_.beginSnapshot(), pagesPerMorsel);
+}
+
+std::vector<HeapFile::ScanIterator> HeapFile::morsels(std::shared_ptr<const Snapshot> snapshot, size_t pagesPerMorsel) {
+    if (pagesPerMorsel == 0) {
+        throw std::invalid_argument("Morsel must contain at least one page");
+    }
+
+    auto pages = getPages();
+    std::vector<ScanIterator> result;
+    for (size_t begin = 0; begin < pages->size(); begin += pagesPerMorsel) {
+        result.push_back(ScanIterator(*this, pages, snapshot, begin, std::min(begin + pagesPerMorsel, pages->size())));
+    }
+    return result;
+}
+
+void HeapFile::parallelScan(size_t numThreads, size_t pagesPerMorsel,
+    const std::function<void(const RID&, const std::vector<uint8_t>&)>& callback) {
+    std::vector<ScanIterator> work = morsels(pagesPerMorsel);
+    std::atomic<size_t> nextMorsel{ 0 };
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto worker = [&]() {
+        try {
+            RID rid;
+            std::vector<uint8_t> record;
+            for (size_t i = nextMorsel++; i < work.size(); i = nextMorsel++) {
+                while (work[i].next(rid, record)) {
+                    callback(rid, record);
+                }
+            }
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+            nextMorsel = work.size(); // Остальные потоки заканчивают работу
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < numThreads; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker(); // Текущий поток тоже участвует
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+
+HeapFile::ScanIterator::ScanIterator(HeapFile& heapFile, std::shared_ptr<const std::vector<size_t>> pages,
+    std::shared_ptr<const Snapshot> snapshot, size_t beginPage, size_t endPage)
+    : heapFile_(&heapFile), pages_(std::move(pages)), snapshot_(std::move(snapshot)),
+    position_(beginPage), endPage_(endPage), current_(0) {
+}
+
+bool HeapFile::ScanIterator::next(RID& rid, std::vector<uint8_t>& record) {
+    while (current_ >= records_.size()) {
+        if (position_ >= endPage_) {
+            return false;
+        }
+
+        // Копируем записи страницы и отпускаем её, затем отбираем версии, видимые в снимке
+        size_t pageIndex = (*pages_)[position_++];
+        std::vector<std::pair<size_t, std::vector<uint8_t>>> raw;
+        heapFile_->readPageRecords(pageIndex, raw);
+
+        records_.clear();
+        current_ = 0;
+        for (auto& entry : raw) {
+            // Перенесённые версии попадают в просмотр через заглушку в слоте RID
+            VersionHeader header = readHeader(entry.second);
+            if (header.flags & MOVED_FLAG) {
+                continue;
+            }
+            if (header.flags & FORWARD_FLAG) {
+                entry.second = heapFile_->readSlot(static_cast<size_t>(header.prevPage), header.prevSlot);
+            }
+            std::vector<uint8_t> data;
+            if (heapFile_->findVisible(entry.second, snapshot_->getTimestamp(), data)) {
+                records_.emplace_back(RID{ pageIndex, entry.first }, std::move(data));
+            }
+        }
+    }
+
+    rid = records_[current_].first;
+    record = std::move(records_[current_].second);
+    ++current_;
+    return true;
+}
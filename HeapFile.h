@@ -0,0 +1,155 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_set>
+#include <functional>
+#include "BufferManager.h"
+#include "Table.h"
+#include "TransactionManager.h"
+
+class HashIndex;
+
+// Идентификатор записи: страница и слот на ней. Не меняется, пока запись не удалена.
+struct RID {
+    size_t pageIndex;
+    size_t slot;
+
+    bool operator==(const RID& other) const {
+        return pageIndex == other.pageIndex && slot == other.slot;
+    }
+};
+
+// Неупорядоченный набор записей таблицы, хранящийся в цепочке страниц BufferManager.
+// Первая страница цепочки однозначно определяет таблицу в файле.
+//
+// Записи версионируются (MVCC): перед данными записи хранится заголовок версии
+// [beginTs, endTs, предыдущая версия]. Слот RID всегда содержит новейшую версию,
+// старые версии копируются в отдельную цепочку страниц (хранилище версий).
+// Если выросшая запись не помещается на своей странице, новая версия переносится на другую
+// страницу таблицы, а в слоте RID остаётся заглушка со ссылкой на неё; чтение и просмотр
+// проходят по заглушке, RID записи не меняется.
+// Читатели работают со снимком и не берут блокировок, которых ждут писатели;
+// писатели одной таблицы выполняются по очереди.
+// Индексы, добавленные через addIndex, обновляются при каждой вставке, изменении и удалении записи.
+class HeapFile {
+public:
+    // Открывает существующую цепочку страниц
+    HeapFile(const Table& table, BufferManager& bufferManager, TransactionManager& transactionManager, size_t firstPageIndex);
+
+    // Создаёт таблицу с одной пустой страницей
+    static HeapFile create(const Table& table, BufferManager& bufferManager, TransactionManager& transactionManager);
+
+    RID insertRecord(const std::vector<uint8_t>& record);
+    std::vector<uint8_t> getRecord(const RID& rid); // Последняя зафиксированная версия
+    std::vector<uint8_t> getRecord(const RID& rid, const Snapshot& snapshot);
+    void updateRecord(const RID& rid, const std::vector<uint8_t>& record);
+    void deleteRecord(const RID& rid);
+
+    // Удаляет версии, которые не видны ни одному снимку. Возвращает число удалённых версий.
+    size_t collectGarbage();
+
+    // Индекс должен жить, пока его не уберут из таблицы. fill: сначала добавить в индекс
+    // все записи таблицы (для нового индекса; открытый по мета-странице индекс уже заполнен).
+    void addIndex(HashIndex& index, bool fill = true);
+    void removeIndex(HashIndex& index);
+
+    const Table& getTable() const;
+    size_t getFirstPage() const;
+    size_t getPageCount();
+    size_t getVersionPageCount();
+    TransactionManager& getTransactionManager() const;
+
+    // Просмотр записей, видимых в снимке, на страницах цепочки [beginPage, endPage).
+    // Записи страницы копируются под разделяемой защёлкой, которая сразу отпускается.
+    class ScanIterator {
+    public:
+        bool next(RID& rid, std::vector<uint8_t>& record);
+
+    private:
+        friend class HeapFile;
+        ScanIterator(HeapFile& heapFile, std::shared_ptr<const std::vector<size_t>> pages,
+            std::shared_ptr<const Snapshot> snapshot, size_t beginPage, size_t endPage);
+
+        HeapFile* heapFile_;
+        std::shared_ptr<const std::vector<size_t>> pages_; // Страницы на момент начала просмотра
+        std::shared_ptr<const Snapshot> snapshot_;
+        size_t position_;  // Позиция следующей страницы в цепочке
+        size_t endPage_;
+        std::vector<std::pair<RID, std::vector<uint8_t>>> records_; // Видимые записи текущей страницы
+        size_t current_;
+    };
+
+    ScanIterator scan(); // В новом снимке
+    ScanIterator scan(std::shared_ptr<const Snapshot> snapshot);
+    ScanIterator scanRange(std::shared_ptr<const Snapshot> snapshot, size_t beginPage, size_t endPage);
+
+    // Делит цепочку на морсели (диапазоны по pagesPerMorsel страниц) для просмотра в разных потоках.
+    // Все морсели читают один снимок.
+    std::vector<ScanIterator> morsels(size_t pagesPerMorsel);
+    std::vector<ScanIterator> morsels(std::shared_ptr<const Snapshot> snapshot, size_t pagesPerMorsel);
+
+    // Просмотр в numThreads потоках: потоки разбирают морсели по одному, пока они не кончатся.
+    // callback вызывается одновременно из разных потоков.
+    void parallelScan(size_t numThreads, size_t pagesPerMorsel,
+        const std::function<void(const RID&, const std::vector<uint8_t>&)>& callback);
+
+private:
+    friend class BulkLoader; // Собирает страницы таблицы в том же формате
+
+    // Заголовок версии в начале каждой записи
+    struct VersionHeader {
+        uint64_t beginTs;
+        uint64_t endTs;
+        uint64_t prevPage; // INVALID_PAGE - старых версий нет
+        uint16_t prevSlot;
+        uint8_t flags = 0; // Хранятся в старших битах prevSlot
+    };
+    static const size_t VERSION_HEADER_SIZE = 26;
+    static const uint8_t FORWARD_FLAG = 1; // Заглушка в слоте RID: prevPage/prevSlot - место новейшей версии
+    static const uint8_t MOVED_FLAG = 2;   // Версия лежит не в слоте своего RID, до неё доходят через заглушку
+
+    static VersionHeader readHeader(const std::vector<uint8_t>& record);
+    static void writeHeader(std::vector<uint8_t>& record, const VersionHeader& header);
+
+    std::vector<uint8_t> readSlot(size_t pageIndex, size_t slot);
+    std::vector<uint8_t> readNewest(const RID& rid, RID& location); // Новейшая версия записи с учётом заглушки
+    void readPageRecords(size_t pageIndex, std::vector<std::pair<size_t, std::vector<uint8_t>>>& records);
+
+    // Данные версии записи, видимой в снимке; false, если такой версии нет
+    bool findVisible(const std::vector<uint8_t>& newest, uint64_t timestamp, std::vector<uint8_t>& record);
+
+    RID insertIntoChain(bool versionStore, const std::vector<uint8_t>& record);
+
+    // Записывает новую версию записи rid, новейшая версия которой current лежит в location
+    // (с endTs = timestamp); старая версия уходит в хранилище версий или остаётся на месте
+    void writeNewVersion(const RID& rid, const RID& location, std::vector<uint8_t>& current,
+        const std::vector<uint8_t>& record, uint64_t timestamp);
+
+    // Элементы индексов для записи rid. Если задана previous, меняются только индексы, ключ которых
+    // отличается от ключа previous. При ошибке добавленные элементы убираются.
+    std::vector<HashIndex*> addIndexEntries(const std::vector<uint8_t>& record, const RID& rid,
+        const std::vector<uint8_t>* previous = nullptr);
+    void removeIndexEntries(const std::vector<HashIndex*>& indexes, const std::vector<uint8_t>& record, const RID& rid);
+    size_t deleteVersionChain(size_t pageIndex, size_t slot); // Удаляет версию и все более старые
+    size_t collectPageGarbage(size_t pageIndex, uint64_t oldest, bool& pending);
+    void recover(); // Приводит таблицу в порядок после открытия
+
+    std::shared_ptr<const std::vector<size_t>> getPages();
+
+    Table table_;
+    BufferManager& bufferManager_;
+    TransactionManager& transactionManager_;
+    size_t firstPageIndex_;
+
+    std::mutex writeMutex_;                 // Очерёдность писателей и сборщика мусора
+    std::mutex pagesMutex_;                 // Защищает указатель pages_
+    std::shared_ptr<const std::vector<size_t>> pages_; // Страницы цепочки по порядку (заменяется целиком)
+    std::vector<size_t> versionPages_;      // Страницы хранилища версий
+    std::vector<size_t> freeVersionPages_;  // Пустые страницы хранилища для повторного использования
+    size_t currentVersionPage_ = INVALID_PAGE; // Страница хранилища, в которую копируются версии
+    std::unordered_set<size_t> garbagePages_; // Страницы таблицы со старыми версиями или удалёнными записями
+    std::set<size_t> freeSpacePages_;       // Страницы таблицы, где удаления освободили место (под writeMutex_)
+    std::vector<HashIndex*> indexes_;       // Под writeMutex_
+};
@@ -3,6 +3,7 @@
 
 
 #include "LRUReplacementStrategy.h"
+#include <stdexcept>
 
 void LRUReplacementStrategy::access(size_t pageIndex) {
     if (pageTable_.find(pageIndex) != pageTable_.end()) {
@@ -15,9 +16,45 @@ void LRUReplacementStrategy::addPage(size_t pageIndex) {
     pageTable_[pageIndex] = lruList_.begin();
 }
 
-size_t LRUReplacementStrategy::evict() {
-    size_t pageIndex = lruList_.back();
-    lruList_.pop_back();
-    pageTable_.erase(pageIndex);
-    return pageIndex;
+size_t LRUReplacementStrategy::evict(const std::function<bool(size_t)>& canEvict) {
+    for (auto it = lruList_.rbegin(); it != lruList_.rend(); ++it) {
+        if (canEvict(*it)) {
+            size_t pageIndex = *it;
+            lruList_.erase(std::next(it).base());
+            pageTable_.erase(pageIndex);
+            return pageIndex;
+        }
+    }
+    throw std::runtime_error("No page can be evicted.");
+}
+
+void LRUReplacementStrategy::removePage(size_t pageIndex) {
+    auto it = pageTable_.find(pageIndex);
+    if (it != pageTable_.end()) {
+        lruList_.erase(it->second);
+        pageTable_.erase(it);
+    }
+}
+
+void LRUReplacementStrategy::clear() {
+    lruList_.clear();
+    pageTable_.clear();
+}
+
+std::vector<size_t> LRUReplacementStrategy::getEvictionOrder() const {
+    return std::vector<size_t>(lruList_.rbegin(), lruList_.rend());
+}
+
+void LRUReplacementStrategy::restoreOrder(const std::vector<size_t>& order) {
+    // Перечисленные страницы переносятся в конец списка, order[0] оказывается последней
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        auto page = pageTable_.find(*it);
+        if (page != pageTable_.end()) {
+            lruList_.splice(lruList_.end(), lruList_, page->second);
+        }
+    }
+}
+
+std::string LRUReplacementStrategy::getDescription() const {
+    return "LRU";
 }
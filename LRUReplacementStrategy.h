@@ -12,7 +12,13 @@ class LRUReplacementStrategy : public ReplacementStrategy {
 public:
     void access(size_t pageIndex) override;
     void addPage(size_t pageIndex) override;
-    size_t evict() override;
+    using ReplacementStrategy::evict;
+    size_t evict(const std::function<bool(size_t)>& canEvict) override;
+    void removePage(size_t pageIndex) override;
+    void clear() override;
+    std::vector<size_t> getEvictionOrder() const override;
+    void restoreOrder(const std::vector<size_t>& order) override;
+    std::string getDescription() const override;
 
 private:
     std::list<size_t> lruList_;
@@ -1,166 +1,265 @@
+#include "Page.h"
 #include <iostream>
 #include <vector>
 #include <stdexcept>
-#include <cstring> //  std::memcpy
+#include <algorithm>
+#include <cstring> // Для std::memcpy
 
-const size_t PAGE_SIZE = 4096;
-const size_t HEADER_SIZE = 128;
+// Смещения полей заголовка
+const size_t RECORD_COUNT_OFFSET = 0;
+const size_t NEXT_PAGE_OFFSET = sizeof(size_t);
+const size_t DATA_START_OFFSET = 2 * sizeof(size_t);
+const size_t VERSION_PAGE_OFFSET = 3 * sizeof(size_t);
 
-class Page {
-public:
-    Page();  //   
 
-    void insertRecord(const std::vector<uint8_t>& record);  //  
-    std::vector<uint8_t> getRecord(size_t index) const;  //    
-    void deleteRecord(size_t index);  //  
-    void updateRecord(size_t index, const std::vector<uint8_t>& newRecord);  //  
-
-    void compactPage();  //   ( )
-
-    std::vector<uint8_t>& getData();  //    
-    const std::vector<uint8_t>& getData() const;  //     
+Page::Page() : data_(PAGE_SIZE, 0) {
+    setRecordCount(0);  // Инициализация страницы с 0 записями
+    setNextPage(INVALID_PAGE);
+    setDataStart(PAGE_SIZE);
+    setVersionPage(INVALID_PAGE);
+}
 
-    size_t getFreeSpace() const;  //     
-    size_t getRecordCount() const;  //     
 
-    //    
-    std::vector<uint8_t> findRecordByKey(const std::vector<uint8_t>& key);
+size_t Page::getRecordCount() const {
+    size_t count;
+    std::memcpy(&count, data_.data() + RECORD_COUNT_OFFSET, sizeof(count));
+    return count;
+}
 
-private:
-    std::vector<uint8_t> data_;  //   (   )
+void Page::setRecordCount(size_t count) {
+    std::memcpy(data_.data() + RECORD_COUNT_OFFSET, &count, sizeof(count));
+}
 
-    size_t getRecordOffset(size_t index) const;  //     
-    void setRecordOffset(size_t index, size_t offset);  //   
-    void setRecordCount(size_t count);  //   
-};
+size_t Page::getNextPage() const {
+    size_t pageIndex;
+    std::memcpy(&pageIndex, data_.data() + NEXT_PAGE_OFFSET, sizeof(pageIndex));
+    return pageIndex;
+}
 
+void Page::setNextPage(size_t pageIndex) {
+    std::memcpy(data_.data() + NEXT_PAGE_OFFSET, &pageIndex, sizeof(pageIndex));
+}
 
-Page::Page() : data_(PAGE_SIZE, 0) {
-    setRecordCount(0);  //    0 
+size_t Page::getVersionPage() const {
+    size_t pageIndex;
+    std::memcpy(&pageIndex, data_.data() + VERSION_PAGE_OFFSET, sizeof(pageIndex));
+    return pageIndex;
 }
 
+void Page::setVersionPage(size_t pageIndex) {
+    std::memcpy(data_.data() + VERSION_PAGE_OFFSET, &pageIndex, sizeof(pageIndex));
+}
 
-size_t Page::getRecordCount() const {
-    return *reinterpret_cast<const size_t*>(data_.data());  //     
+size_t Page::getDataStart() const {
+    size_t offset;
+    std::memcpy(&offset, data_.data() + DATA_START_OFFSET, sizeof(offset));
+    return offset;
 }
 
-void Page::setRecordCount(size_t count) {
-    *reinterpret_cast<size_t*>(data_.data()) = count;
+void Page::setDataStart(size_t offset) {
+    std::memcpy(data_.data() + DATA_START_OFFSET, &offset, sizeof(offset));
 }
 
 
-size_t Page::getRecordOffset(size_t index) const {
+Page::Slot Page::getSlot(size_t index) const {
     if (index >= getRecordCount()) {
         throw std::out_of_range("Invalid record index");
     }
-    const size_t* offsets = reinterpret_cast<const size_t*>(data_.data() + sizeof(size_t));
-    return offsets[index];
+    Slot slot;
+    std::memcpy(&slot, data_.data() + HEADER_SIZE + index * sizeof(Slot), sizeof(Slot));
+    return slot;
 }
 
-void Page::setRecordOffset(size_t index, size_t offset) {
-    size_t* offsets = reinterpret_cast<size_t*>(data_.data() + sizeof(size_t));
-    offsets[index] = offset;
+void Page::setSlot(size_t index, Slot slot) {
+    std::memcpy(data_.data() + HEADER_SIZE + index * sizeof(Slot), &slot, sizeof(Slot));
 }
 
-size_t Page::getFreeSpace() const {
+bool Page::isRecordDeleted(size_t index) const {
+    return getSlot(index).offset == 0;
+}
+
+void Page::validateRecord(size_t index) const {
+    if (isRecordDeleted(index)) {
+        throw std::out_of_range("Record has been deleted");
+    }
+}
+
+size_t Page::getUsedSpace() const {
+    size_t recordCount = getRecordCount();
+    size_t usedSpace = HEADER_SIZE + recordCount * sizeof(Slot);
+    for (size_t i = 0; i < recordCount; ++i) {
+        Slot slot = getSlot(i);
+        if (slot.offset != 0) {
+            usedSpace += slot.length;
+        }
+    }
+    return usedSpace;
+}
+
+void Page::scanSlots(size_t& usedSpace, size_t& freeSlot) const {
     size_t recordCount = getRecordCount();
-    size_t usedSpace = HEADER_SIZE + recordCount * sizeof(size_t);
-    if (recordCount > 0) {
-        size_t lastOffset = getRecordOffset(recordCount - 1);
-        usedSpace += PAGE_SIZE - lastOffset;
+    usedSpace = HEADER_SIZE + recordCount * sizeof(Slot);
+    freeSlot = recordCount;
+    for (size_t i = 0; i < recordCount; ++i) {
+        Slot slot = getSlot(i);
+        if (slot.offset != 0) {
+            usedSpace += slot.length;
+        }
+        else if (freeSlot == recordCount) {
+            freeSlot = i;
+        }
+    }
+    // Новой записи может понадобиться новый слот
+    if (freeSlot == recordCount) {
+        usedSpace += sizeof(Slot);
     }
-    return PAGE_SIZE - usedSpace;
 }
 
-void Page::insertRecord(const std::vector<uint8_t>& record) {
-    if (record.size() > getFreeSpace()) {
+size_t Page::getFreeSpace() const {
+    // Свободное место с учётом "дыр" после удалений (их убирает compactPage)
+    size_t usedSpace;
+    size_t freeSlot;
+    scanSlots(usedSpace, freeSlot);
+    return usedSpace < PAGE_SIZE ? PAGE_SIZE - usedSpace : 0;
+}
+
+size_t Page::getRecordOverhead() {
+    return sizeof(Slot);
+}
+
+size_t Page::insertRecord(const std::vector<uint8_t>& record) {
+    // Один проход по каталогу слотов: занятое место и первый свободный слот
+    size_t usedSpace;
+    size_t slotIndex;
+    scanSlots(usedSpace, slotIndex);
+    if (usedSpace > PAGE_SIZE || record.size() > PAGE_SIZE - usedSpace) {
         throw std::runtime_error("Record exceeds page size");
     }
 
     size_t recordCount = getRecordCount();
-    size_t offset = (recordCount > 0) ? getRecordOffset(recordCount - 1) + record.size() : HEADER_SIZE;
+    size_t slotDirEnd = HEADER_SIZE + std::max(recordCount, slotIndex + 1) * sizeof(Slot);
 
-    if (offset + record.size() > PAGE_SIZE) {
-        throw std::runtime_error("Calculated offset exceeds page size");
+    if (getDataStart() < slotDirEnd + record.size()) {
+        compactPage();
     }
 
+    size_t offset = getDataStart() - record.size();
     std::memcpy(data_.data() + offset, record.data(), record.size());
-    setRecordOffset(recordCount, offset);
+    setDataStart(offset);
+
+    if (slotIndex == recordCount) {
+        setRecordCount(recordCount + 1);
+    }
+    setSlot(slotIndex, { static_cast<uint16_t>(offset), static_cast<uint16_t>(record.size()) });
+    return slotIndex;
+}
+
+size_t Page::appendRecord(const std::vector<uint8_t>& record) {
+    size_t recordCount = getRecordCount();
+    size_t slotDirEnd = HEADER_SIZE + (recordCount + 1) * sizeof(Slot);
+    if (getDataStart() < slotDirEnd || getDataStart() - slotDirEnd < record.size()) {
+        throw std::runtime_error("Record exceeds page size");
+    }
+
+    size_t offset = getDataStart() - record.size();
+    std::memcpy(data_.data() + offset, record.data(), record.size());
+    setDataStart(offset);
     setRecordCount(recordCount + 1);
+    setSlot(recordCount, { static_cast<uint16_t>(offset), static_cast<uint16_t>(record.size()) });
+    return recordCount;
 }
 
 std::vector<uint8_t> Page::getRecord(size_t index) const {
-    size_t offset = getRecordOffset(index);
-    size_t nextOffset = (index + 1 < getRecordCount()) ? getRecordOffset(index + 1) : PAGE_SIZE;
-    size_t recordSize = nextOffset - offset;
-    std::vector<uint8_t> record(recordSize);
-    std::memcpy(record.data(), data_.data() + offset, recordSize);
+    validateRecord(index);
+    Slot slot = getSlot(index);
+    std::vector<uint8_t> record(slot.length);
+    std::memcpy(record.data(), data_.data() + slot.offset, slot.length);
     return record;
 }
 
 
 void Page::deleteRecord(size_t index) {
-    if (index >= getRecordCount()) {
-        throw std::out_of_range("Invalid record index");
-    }
-
-    size_t* offsets = reinterpret_cast<size_t*>(data_.data() + sizeof(size_t));
-    offsets[index] = -1;  //   
+    validateRecord(index);
+    setSlot(index, { 0, 0 });  // Помечаем как удалённую, место освободит compactPage
 
-    //   ,   
-    for (size_t i = index + 1; i < getRecordCount(); ++i) {
-        size_t offset = getRecordOffset(i);
-        setRecordOffset(i - 1, offset); //   
+    // Хвостовые удалённые слоты можно убрать из каталога
+    size_t recordCount = getRecordCount();
+    while (recordCount > 0 && getSlot(recordCount - 1).offset == 0) {
+        --recordCount;
+        setRecordCount(recordCount);
     }
-
-    //   
-    setRecordCount(getRecordCount() - 1);
 }
 
 
-
-
+bool Page::canUpdateRecord(size_t index, size_t newSize) const {
+    validateRecord(index);
+    Slot slot = getSlot(index);
+    return newSize <= slot.length || getUsedSpace() - slot.length + newSize <= PAGE_SIZE;
+}
 
 void Page::updateRecord(size_t index, const std::vector<uint8_t>& newRecord) {
-    if (newRecord.size() > getFreeSpace()) {
+    validateRecord(index);
+    Slot slot = getSlot(index);
+
+    // Новая запись помещается на старое место
+    if (newRecord.size() <= slot.length) {
+        std::memcpy(data_.data() + slot.offset, newRecord.data(), newRecord.size());
+        setSlot(index, { slot.offset, static_cast<uint16_t>(newRecord.size()) });
+        return;
+    }
+
+    // Иначе переносим запись внутри страницы, сохраняя номер слота
+    setSlot(index, { 0, 0 });
+    if (PAGE_SIZE - getUsedSpace() < newRecord.size()) {
+        setSlot(index, slot);
         throw std::runtime_error("Not enough free space to update the record");
     }
 
-    size_t offset = getRecordOffset(index);
+    size_t slotDirEnd = HEADER_SIZE + getRecordCount() * sizeof(Slot);
+    if (getDataStart() < slotDirEnd + newRecord.size()) {
+        compactPage();
+    }
+
+    size_t offset = getDataStart() - newRecord.size();
     std::memcpy(data_.data() + offset, newRecord.data(), newRecord.size());
+    setDataStart(offset);
+    setSlot(index, { static_cast<uint16_t>(offset), static_cast<uint16_t>(newRecord.size()) });
 }
 
 
 
 void Page::compactPage() {
     size_t recordCount = getRecordCount();
-    size_t freeSpace = PAGE_SIZE - HEADER_SIZE - recordCount * sizeof(size_t);
-
-    if (freeSpace > 0) {
-        //    ,  
-        std::vector<uint8_t> newData(PAGE_SIZE, 0);
-        size_t offset = HEADER_SIZE + recordCount * sizeof(size_t);
-
-        for (size_t i = 0; i < recordCount; ++i) {
-            size_t recordOffset = getRecordOffset(i);
-            size_t recordSize = (i + 1 < recordCount) ? getRecordOffset(i + 1) - recordOffset : PAGE_SIZE - recordOffset;
-            std::memcpy(newData.data() + offset, data_.data() + recordOffset, recordSize);
-            setRecordOffset(i, offset);
-            offset += recordSize;
+    std::vector<uint8_t> newData(data_.begin(), data_.begin() + HEADER_SIZE + recordCount * sizeof(Slot));
+    newData.resize(PAGE_SIZE, 0);
+
+    size_t offset = PAGE_SIZE;
+    for (size_t i = 0; i < recordCount; ++i) {
+        Slot slot = getSlot(i);
+        if (slot.offset == 0) {
+            continue;
         }
-
-        //   
-        data_ = std::move(newData);
+        offset -= slot.length;
+        std::memcpy(newData.data() + offset, data_.data() + slot.offset, slot.length);
+        Slot moved = { static_cast<uint16_t>(offset), slot.length };
+        std::memcpy(newData.data() + HEADER_SIZE + i * sizeof(Slot), &moved, sizeof(Slot));
     }
+
+    // Обновляем данные страницы
+    data_ = std::move(newData);
+    setDataStart(offset);
 }
 
 
 
 std::vector<uint8_t> Page::findRecordByKey(const std::vector<uint8_t>& key) {
     for (size_t i = 0; i < getRecordCount(); ++i) {
+        if (isRecordDeleted(i)) {
+            continue;
+        }
         std::vector<uint8_t> record = getRecord(i);
-        if (std::equal(record.begin(), record.end(), key.begin())) {
-            return record;  //  ,   
+        if (record.size() >= key.size() && std::equal(key.begin(), key.end(), record.begin())) {
+            return record;  // Возвращаем запись, если ключ найден
         }
     }
     throw std::runtime_error("Record with the given key not found");
@@ -4,34 +4,70 @@
 #include <vector>
 #include <cstdint>
 #include <stdexcept>
-#include <cstring> //  std::memcpy
+#include <cstring> // Для std::memcpy
 
-const size_t PAGE_SIZE = 4096;  //  
-const size_t HEADER_SIZE = 128; //   
+const size_t PAGE_SIZE = 4096;  // Размер страницы
+const size_t HEADER_SIZE = 128; // Размер заголовка страницы
+const size_t INVALID_PAGE = static_cast<size_t>(-1); // Нет страницы (конец цепочки)
 
+// Формат страницы:
+//   [0, HEADER_SIZE)         заголовок: число слотов, следующая страница цепочки, начало области записей,
+//                            первая страница хранилища версий
+//   [HEADER_SIZE, ...)       каталог слотов (offset, length), растёт вверх
+//   [..., PAGE_SIZE)         данные записей, растут вниз от конца страницы
+// Номер слота записи не меняется до её удаления, поэтому (страница, слот) можно использовать как RID.
 class Page {
 public:
     Page();
 
-    //    
-    void insertRecord(const std::vector<uint8_t>& record);
+    // Методы работы с записями
+    size_t insertRecord(const std::vector<uint8_t>& record); // Возвращает номер слота
+    // Новый слот в конце каталога без обхода слотов (удалённые слоты не переиспользуются).
+    // Для заполнения новых страниц: запись должна поместиться в непрерывное свободное место
+    size_t appendRecord(const std::vector<uint8_t>& record);
     std::vector<uint8_t> getRecord(size_t index) const;
     void deleteRecord(size_t index);
+    void updateRecord(size_t index, const std::vector<uint8_t>& newRecord);
+    bool canUpdateRecord(size_t index, size_t newSize) const; // Поместится ли запись нового размера в слот
+    bool isRecordDeleted(size_t index) const;
 
-    //      
+    void compactPage(); // Сдвигает записи к концу страницы, номера слотов сохраняются
+
+    // Методы для доступа к данным страницы
     std::vector<uint8_t>& getData();
     const std::vector<uint8_t>& getData() const;
 
     void validateRecord(size_t index) const;
 
     size_t getFreeSpace() const;
-    size_t getRecordCount() const; //  
+    static size_t getRecordOverhead(); // Место под слот, которое запись занимает сверх своих данных
+    size_t getRecordCount() const; // Число слотов, включая удалённые
+
+    // Связь страниц одной таблицы в цепочку
+    size_t getNextPage() const;
+    void setNextPage(size_t pageIndex);
+
+    // Первая страница хранилища старых версий (заполняется только в первой странице таблицы)
+    size_t getVersionPage() const;
+    void setVersionPage(size_t pageIndex);
+
+    // Поиск записи по ключу
+    std::vector<uint8_t> findRecordByKey(const std::vector<uint8_t>& key);
 private:
-    std::vector<uint8_t> data_; //   ( )
+    struct Slot {
+        uint16_t offset; // 0 - запись удалена
+        uint16_t length;
+    };
+
+    std::vector<uint8_t> data_; // Данные страницы (включая заголовок)
 
-    //     
-    size_t getRecordOffset(size_t index) const;
-    void setRecordOffset(size_t index, size_t offset);
+    // Методы для работы с заголовком
+    Slot getSlot(size_t index) const;
+    void setSlot(size_t index, Slot slot);
+    size_t getDataStart() const;
+    void setDataStart(size_t offset);
 
     void setRecordCount(size_t count);
+    void scanSlots(size_t& usedSpace, size_t& freeSlot) const; // Занятое место с учётом нового слота
+    size_t getUsedSpace() const; // Заголовок, каталог слотов и живые записи
 };
@@ -0,0 +1,222 @@
+#include "PageCompressor.h"
+#include <stdexcept>
+#include <algorithm>
+#include <cstring> // Для std::memcpy
+#include <bit>     // Для std::countr_zero
+
+const size_t MIN_MATCH = 4;         // Минимальная длина совпадения
+const size_t LAST_LITERALS = 5;     // Последние байты всегда идут литералами
+const size_t MATCH_FIND_LIMIT = 12; // Совпадение не начинается ближе к концу
+const size_t MAX_OFFSET = 65535;
+const size_t HASH_BITS = 12;
+const size_t HIGH_MAX_ATTEMPTS = 64; // Сколько кандидатов проверяет режим High
+
+static uint32_t read32(const uint8_t* data) {
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static uint64_t read64(const uint8_t* data) {
+    uint64_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+// Длина общего префикса (не больше limit): сравниваем по 8 байт, первый различающийся байт
+// находим по младшему ненулевому биту разности (порядок байт little-endian)
+static size_t commonLength(const uint8_t* left, const uint8_t* right, size_t limit) {
+    size_t length = 0;
+    while (length + 8 <= limit) {
+        uint64_t diff = read64(left + length) ^ read64(right + length);
+        if (diff != 0) {
+            return length + std::countr_zero(diff) / 8;
+        }
+        length += 8;
+    }
+    while (length < limit && left[length] == right[length]) {
+        ++length;
+    }
+    return length;
+}
+
+static size_t hash4(uint32_t value) {
+    return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static void writeLength(std::vector<uint8_t>& out, size_t length) {
+    while (length >= 255) {
+        out.push_back(255);
+        length -= 255;
+    }
+    out.push_back(static_cast<uint8_t>(length));
+}
+
+// matchLength == 0 - последовательность без совпадения (конец потока)
+static void emitSequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t literalLength, size_t offset, size_t matchLength) {
+    size_t matchCode = matchLength > 0 ? matchLength - MIN_MATCH : 0;
+    out.push_back(static_cast<uint8_t>((std::min<size_t>(literalLength, 15) << 4) | std::min<size_t>(matchCode, 15)));
+    if (literalLength >= 15) {
+        writeLength(out, literalLength - 15);
+    }
+    out.insert(out.end(), literals, literals + literalLength);
+
+    if (matchLength > 0) {
+        out.push_back(static_cast<uint8_t>(offset & 0xFF));
+        out.push_back(static_cast<uint8_t>(offset >> 8));
+        if (matchCode >= 15) {
+            writeLength(out, matchCode - 15);
+        }
+    }
+}
+
+std::vector<uint8_t> PageCompressor::compress(const uint8_t* data, size_t size, CompressionMode mode) {
+    if (mode == CompressionMode::None) {
+        return std::vector<uint8_t>(data, data + size);
+    }
+
+    std::vector<uint8_t> out;
+    out.reserve(size + size / 255 + 16);
+    size_t anchor = 0; // Начало ещё не записанных литералов
+
+    if (size >= MATCH_FIND_LIMIT) {
+        bool high = mode == CompressionMode::High;
+        std::vector<int32_t> head(size_t(1) << HASH_BITS, -1);
+        std::vector<int32_t> chain(high ? size : 0, -1);
+        size_t matchLimit = size - LAST_LITERALS;
+
+        size_t pos = 0;
+        while (pos + MATCH_FIND_LIMIT <= size) {
+            uint32_t sequence = read32(data + pos);
+            size_t hash = hash4(sequence);
+            int32_t candidate = head[hash];
+            if (high) {
+                chain[pos] = candidate;
+            }
+            head[hash] = static_cast<int32_t>(pos);
+
+            size_t bestLength = 0;
+            size_t bestPos = 0;
+            size_t attempts = high ? HIGH_MAX_ATTEMPTS : 1;
+            while (candidate >= 0 && attempts-- > 0 && pos - candidate <= MAX_OFFSET) {
+                if (read32(data + candidate) == sequence) {
+                    size_t length = MIN_MATCH;
+                    if (pos + length < matchLimit) {
+                        length += commonLength(data + candidate + length, data + pos + length, matchLimit - pos - length);
+                    }
+                    if (length > bestLength) {
+                        bestLength = length;
+                        bestPos = candidate;
+                    }
+                }
+                candidate = high ? chain[candidate] : -1;
+            }
+
+            if (bestLength < MIN_MATCH) {
+                ++pos;
+                continue;
+            }
+
+            emitSequence(out, data + anchor, pos - anchor, pos - bestPos, bestLength);
+
+            // В режиме High позиции внутри совпадения тоже попадают в цепочки
+            if (high) {
+                for (size_t p = pos + 1; p < pos + bestLength && p + MIN_MATCH <= size; ++p) {
+                    size_t h = hash4(read32(data + p));
+                    chain[p] = head[h];
+                    head[h] = static_cast<int32_t>(p);
+                }
+            }
+
+            pos += bestLength;
+            anchor = pos;
+        }
+    }
+
+    emitSequence(out, data + anchor, size - anchor, 0, 0);
+    return out;
+}
+
+static size_t readLength(const uint8_t* src, size_t srcSize, size_t& in) {
+    size_t length = 0;
+    uint8_t byte;
+    do {
+        if (in >= srcSize) {
+            throw std::runtime_error("Corrupted compressed page.");
+        }
+        byte = src[in++];
+        length += byte;
+    } while (byte == 255);
+    return length;
+}
+
+void PageCompressor::decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) {
+    size_t in = 0;
+    size_t out = 0;
+
+    while (true) {
+        if (in >= srcSize) {
+            throw std::runtime_error("Corrupted compressed page.");
+        }
+        uint8_t token = src[in++];
+
+        size_t literalLength = token >> 4;
+        if (literalLength == 15) {
+            literalLength += readLength(src, srcSize, in);
+        }
+        if (in + literalLength > srcSize || out + literalLength > dstSize) {
+            throw std::runtime_error("Corrupted compressed page.");
+        }
+        if (literalLength <= 16 && in + 16 <= srcSize && out + 16 <= dstSize) {
+            std::memcpy(dst + out, src + in, 16); // Лишние байты перезапишет следующая последовательность
+        }
+        else if (literalLength > 0) {
+            std::memcpy(dst + out, src + in, literalLength);
+        }
+        in += literalLength;
+        out += literalLength;
+
+        if (in == srcSize) {
+            break; // Последняя последовательность без совпадения
+        }
+
+        if (in + 2 > srcSize) {
+            throw std::runtime_error("Corrupted compressed page.");
+        }
+        size_t offset = src[in] | (static_cast<size_t>(src[in + 1]) << 8);
+        in += 2;
+
+        size_t matchLength = (token & 15) + MIN_MATCH;
+        if ((token & 15) == 15) {
+            matchLength += readLength(src, srcSize, in);
+        }
+        if (offset == 0 || offset > out || out + matchLength > dstSize) {
+            throw std::runtime_error("Corrupted compressed page.");
+        }
+
+        // Копируем по 8 байт. Совпадение может перекрываться с копируемыми байтами: при смещении меньше 8
+        // данные повторяются с периодом offset, поэтому, скопировав по байту первые distance - offset байт,
+        // дальше можно копировать словами с расстояния distance (кратного offset и не меньшего 8)
+        size_t distance = offset;
+        size_t i = 0;
+        if (offset < 8) {
+            distance = offset * ((8 + offset - 1) / offset);
+            for (; i < std::min(distance - offset, matchLength); ++i) {
+                dst[out + i] = dst[out + i - offset];
+            }
+        }
+        // Если за совпадением есть место, последнее слово копируем целиком: лишние байты ещё не декодированы
+        size_t wordEnd = out + matchLength + 8 <= dstSize ? matchLength + 7 : matchLength;
+        for (; i + 8 <= wordEnd; i += 8) {
+            std::memcpy(dst + out + i, dst + out + i - distance, 8);
+        }
+        for (; i < matchLength; ++i) {
+            dst[out + i] = dst[out + i - distance];
+        }
+        out += matchLength;
+    }
+
+    if (out != dstSize) {
+        throw std::runtime_error("Corrupted compressed page.");
+    }
+}
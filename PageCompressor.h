@@ -0,0 +1,21 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+enum class CompressionMode : uint8_t {
+    None = 0,  // Страница хранится как есть
+    Fast = 1,  // Один кандидат на совпадение из хеш-таблицы (уровень LZ4)
+    High = 2   // Поиск самого длинного совпадения по хеш-цепочкам (медленнее, сжимает лучше)
+};
+
+// Сжатие страниц в формате блоков LZ4: последовательности
+// [токен][длина литералов][литералы][смещение 2 байта][длина совпадения].
+// Поток всегда заканчивается последовательностью из одних литералов.
+class PageCompressor {
+public:
+    static std::vector<uint8_t> compress(const uint8_t* data, size_t size, CompressionMode mode);
+
+    // Распаковывает ровно dstSize байт в dst, при повреждённых данных бросает исключение
+    static void decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize);
+};
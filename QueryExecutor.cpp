@@ -0,0 +1,328 @@
+#include "QueryExecutor.h"
+#include <stdexcept>
+#include <limits>
+#include <algorithm>
+
+void Batch::reset(size_t columnCount) {
+    columns.resize(columnCount);
+    for (auto& column : columns) {
+        column.clear();
+    }
+    rowCount = 0;
+}
+
+void Batch::appendRow(const Batch& source, size_t row) {
+    for (size_t i = 0; i < columns.size(); ++i) {
+        columns[i].push_back(source.columns[i][row]);
+    }
+    ++rowCount;
+}
+
+size_t RowHash::operator()(const Row& row) const {
+    size_t hash = 0;
+    for (const auto& value : row) {
+        hash ^= std::hash<Value>{}(value) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    }
+    return hash;
+}
+
+
+ScanOperator::ScanOperator(HeapFile::ScanIterator iterator, const Table& table)
+    : iterator_(std::move(iterator)), table_(table) {
+}
+
+bool ScanOperator::next(Batch& batch) {
+    batch.reset(table_.columns.size());
+
+    RID rid;
+    std::vector<uint8_t> record;
+    while (batch.rowCount < BATCH_SIZE && iterator_.next(rid, record)) {
+        Row row = table_.decodeRecord(record);
+        for (size_t i = 0; i < row.size(); ++i) {
+            batch.columns[i].push_back(std::move(row[i]));
+        }
+        ++batch.rowCount;
+    }
+    return batch.rowCount > 0;
+}
+
+
+FilterOperator::FilterOperator(std::unique_ptr<Operator> child, Predicate predicate)
+    : child_(std::move(child)), predicate_(std::move(predicate)) {
+}
+
+bool FilterOperator::next(Batch& batch) {
+    // Пропускаем пакеты, в которых не осталось ни одной строки
+    while (child_->next(input_)) {
+        batch.reset(input_.columns.size());
+        for (size_t row = 0; row < input_.rowCount; ++row) {
+            if (predicate_(input_, row)) {
+                batch.appendRow(input_, row);
+            }
+        }
+        if (batch.rowCount > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+ProjectOperator::ProjectOperator(std::unique_ptr<Operator> child, const std::vector<size_t>& columns)
+    : child_(std::move(child)), columns_(columns) {
+}
+
+bool ProjectOperator::next(Batch& batch) {
+    if (!child_->next(input_)) {
+        return false;
+    }
+
+    batch.reset(columns_.size());
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        batch.columns[i] = input_.columns.at(columns_[i]);
+    }
+    batch.rowCount = input_.rowCount;
+    return true;
+}
+
+
+JoinHashTable::JoinHashTable(size_t partitionCount) : partitions_(std::max<size_t>(1, partitionCount)) {
+}
+
+size_t JoinHashTable::getPartitionIndex(const Value& key) const {
+    return std::hash<Value>{}(key) % partitions_.size();
+}
+
+size_t JoinHashTable::getPartitionCount() const {
+    return partitions_.size();
+}
+
+JoinHashTable::Partition& JoinHashTable::getPartition(size_t index) {
+    return partitions_[index];
+}
+
+const JoinHashTable::Partition& JoinHashTable::getPartitionFor(const Value& key) const {
+    return partitions_[getPartitionIndex(key)];
+}
+
+size_t JoinHashTable::size() const {
+    size_t total = 0;
+    for (const auto& partition : partitions_) {
+        total += partition.size();
+    }
+    return total;
+}
+
+
+HashJoinProbeOperator::HashJoinProbeOperator(std::unique_ptr<Operator> child, const JoinHashTable& hashTable, size_t keyColumn)
+    : child_(std::move(child)), hashTable_(hashTable), keyColumn_(keyColumn) {
+}
+
+bool HashJoinProbeOperator::next(Batch& batch) {
+    while (child_->next(input_)) {
+        size_t probeColumns = input_.columns.size();
+        batch.reset(probeColumns);
+
+        for (size_t row = 0; row < input_.rowCount; ++row) {
+            const Value& key = input_.columns[keyColumn_][row];
+            auto range = hashTable_.getPartitionFor(key).equal_range(key);
+            for (auto it = range.first; it != range.second; ++it) {
+                const Row& buildRow = it->second;
+                if (batch.columns.size() == probeColumns) {
+                    batch.columns.resize(probeColumns + buildRow.size());
+                }
+                for (size_t i = 0; i < probeColumns; ++i) {
+                    batch.columns[i].push_back(input_.columns[i][row]);
+                }
+                for (size_t i = 0; i < buildRow.size(); ++i) {
+                    batch.columns[probeColumns + i].push_back(buildRow[i]);
+                }
+                ++batch.rowCount;
+            }
+        }
+
+        if (batch.rowCount > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+QueryExecutor::QueryExecutor(size_t numThreads, size_t pagesPerMorsel)
+    : pool_(numThreads), pagesPerMorsel_(pagesPerMorsel) {
+}
+
+size_t QueryExecutor::getThreadCount() const {
+    return pool_.getThreadCount();
+}
+
+size_t QueryExecutor::getStolenCount() const {
+    return pool_.getStolenCount();
+}
+
+void QueryExecutor::run(HeapFile& heapFile, const PipelineFactory& pipeline, const Sink& sink) {
+    std::vector<HeapFile::ScanIterator> morsels = heapFile.morsels(pagesPerMorsel_);
+
+    std::vector<WorkStealingPool::Task> tasks;
+    for (size_t i = 0; i < morsels.size(); ++i) {
+        tasks.push_back([&, i](size_t workerId) {
+            std::unique_ptr<Operator> root = std::make_unique<ScanOperator>(std::move(morsels[i]), heapFile.getTable());
+            if (pipeline) {
+                root = pipeline(std::move(root));
+            }
+
+            Batch batch;
+            while (root->next(batch)) {
+                sink(workerId, batch);
+            }
+        });
+    }
+    pool_.run(std::move(tasks));
+}
+
+std::vector<Row> QueryExecutor::collect(HeapFile& heapFile, const PipelineFactory& pipeline) {
+    std::vector<std::vector<Row>> local(getThreadCount());
+
+    run(heapFile, pipeline, [&](size_t workerId, const Batch& batch) {
+        for (size_t row = 0; row < batch.rowCount; ++row) {
+            Row values;
+            values.reserve(batch.columns.size());
+            for (const auto& column : batch.columns) {
+                values.push_back(column[row]);
+            }
+            local[workerId].push_back(std::move(values));
+        }
+    });
+
+    std::vector<Row> result;
+    for (auto& rows : local) {
+        result.insert(result.end(), std::make_move_iterator(rows.begin()), std::make_move_iterator(rows.end()));
+    }
+    return result;
+}
+
+std::vector<Row> QueryExecutor::aggregate(HeapFile& heapFile, const PipelineFactory& pipeline,
+    const std::vector<size_t>& groupBy, const std::vector<Aggregate>& aggregates) {
+    using Groups = std::unordered_map<Row, std::vector<int64_t>, RowHash>;
+
+    std::vector<int64_t> initial;
+    for (const auto& aggregate : aggregates) {
+        switch (aggregate.function) {
+        case AggregateFunction::Min:
+            initial.push_back(std::numeric_limits<int64_t>::max());
+            break;
+        case AggregateFunction::Max:
+            initial.push_back(std::numeric_limits<int64_t>::min());
+            break;
+        default:
+            initial.push_back(0);
+            break;
+        }
+    }
+
+    auto combine = [&](std::vector<int64_t>& state, size_t i, int64_t value) {
+        switch (aggregates[i].function) {
+        case AggregateFunction::Count:
+        case AggregateFunction::Sum:
+            state[i] += value;
+            break;
+        case AggregateFunction::Min:
+            state[i] = std::min(state[i], value);
+            break;
+        case AggregateFunction::Max:
+            state[i] = std::max(state[i], value);
+            break;
+        }
+    };
+
+    // Локальные группы потока разбиты на секции, чтобы слияние шло параллельно по секциям
+    size_t partitionCount = getThreadCount();
+    std::vector<std::vector<Groups>> local(getThreadCount(), std::vector<Groups>(partitionCount));
+
+    run(heapFile, pipeline, [&](size_t workerId, const Batch& batch) {
+        Row key(groupBy.size());
+        for (size_t row = 0; row < batch.rowCount; ++row) {
+            for (size_t i = 0; i < groupBy.size(); ++i) {
+                key[i] = batch.columns[groupBy[i]][row];
+            }
+            Groups& groups = local[workerId][RowHash{}(key) % partitionCount];
+            auto it = groups.find(key);
+            if (it == groups.end()) {
+                it = groups.emplace(key, initial).first;
+            }
+            for (size_t i = 0; i < aggregates.size(); ++i) {
+                int64_t value = aggregates[i].function == AggregateFunction::Count
+                    ? 1 : std::get<int64_t>(batch.columns[aggregates[i].column][row]);
+                combine(it->second, i, value);
+            }
+        }
+    });
+
+    std::vector<Groups> merged(partitionCount);
+    std::vector<WorkStealingPool::Task> tasks;
+    for (size_t partition = 0; partition < partitionCount; ++partition) {
+        tasks.push_back([&, partition](size_t) {
+            Groups& target = merged[partition];
+            for (auto& workerGroups : local) {
+                for (auto& entry : workerGroups[partition]) {
+                    auto it = target.find(entry.first);
+                    if (it == target.end()) {
+                        target.emplace(entry.first, std::move(entry.second));
+                        continue;
+                    }
+                    for (size_t i = 0; i < aggregates.size(); ++i) {
+                        combine(it->second, i, entry.second[i]);
+                    }
+                }
+            }
+        });
+    }
+    pool_.run(std::move(tasks));
+
+    std::vector<Row> result;
+    for (auto& groups : merged) {
+        for (auto& entry : groups) {
+            Row row = entry.first;
+            row.insert(row.end(), entry.second.begin(), entry.second.end());
+            result.push_back(std::move(row));
+        }
+    }
+    if (groupBy.empty() && result.empty()) {
+        result.emplace_back(initial.begin(), initial.end()); // Агрегат по всей пустой таблице
+    }
+    return result;
+}
+
+JoinHashTable QueryExecutor::buildHashTable(HeapFile& heapFile, const PipelineFactory& pipeline, size_t keyColumn) {
+    JoinHashTable hashTable(getThreadCount());
+    using Entries = std::vector<std::pair<Value, Row>>;
+    std::vector<std::vector<Entries>> local(getThreadCount(), std::vector<Entries>(hashTable.getPartitionCount()));
+
+    run(heapFile, pipeline, [&](size_t workerId, const Batch& batch) {
+        for (size_t row = 0; row < batch.rowCount; ++row) {
+            Row values;
+            values.reserve(batch.columns.size());
+            for (const auto& column : batch.columns) {
+                values.push_back(column[row]);
+            }
+            const Value& key = batch.columns[keyColumn][row];
+            local[workerId][hashTable.getPartitionIndex(key)].emplace_back(key, std::move(values));
+        }
+    });
+
+    std::vector<WorkStealingPool::Task> tasks;
+    for (size_t partition = 0; partition < hashTable.getPartitionCount(); ++partition) {
+        tasks.push_back([&, partition](size_t) {
+            JoinHashTable::Partition& target = hashTable.getPartition(partition);
+            for (auto& workerEntries : local) {
+                for (auto& entry : workerEntries[partition]) {
+                    target.emplace(std::move(entry.first), std::move(entry.second));
+                }
+            }
+        });
+    }
+    pool_.run(std::move(tasks));
+
+    return hashTable;
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include "HeapFile.h"
+#include "Table.h"
+#include "WorkStealingPool.h"
+
+const size_t BATCH_SIZE = 1024; // Максимальное число строк в пакете
+
+// Пакет строк в колоночном виде: columns[колонка][строка]
+struct Batch {
+    std::vector<std::vector<Value>> columns;
+    size_t rowCount = 0;
+
+    void reset(size_t columnCount);
+    void appendRow(const Batch& source, size_t row);
+};
+
+struct RowHash {
+    size_t operator()(const Row& row) const;
+};
+
+// Оператор конвейера: следующий пакет запрашивается у дочернего оператора (pull-модель)
+class Operator {
+public:
+    virtual ~Operator() = default;
+
+    // Заполняет batch; false, если данных больше нет
+    virtual bool next(Batch& batch) = 0;
+};
+
+// Чтение записей одного морселя и декодирование их по схеме таблицы
+class ScanOperator : public Operator {
+public:
+    ScanOperator(HeapFile::ScanIterator iterator, const Table& table);
+    bool next(Batch& batch) override;
+
+private:
+    HeapFile::ScanIterator iterator_;
+    const Table& table_;
+};
+
+class FilterOperator : public Operator {
+public:
+    using Predicate = std::function<bool(const Batch& batch, size_t row)>;
+
+    FilterOperator(std::unique_ptr<Operator> child, Predicate predicate);
+    bool next(Batch& batch) override;
+
+private:
+    std::unique_ptr<Operator> child_;
+    Predicate predicate_;
+    Batch input_;
+};
+
+class ProjectOperator : public Operator {
+public:
+    ProjectOperator(std::unique_ptr<Operator> child, const std::vector<size_t>& columns);
+    bool next(Batch& batch) override;
+
+private:
+    std::unique_ptr<Operator> child_;
+    std::vector<size_t> columns_;
+    Batch input_;
+};
+
+// Хеш-таблица стороны построения соединения, разбитая на секции по хешу ключа.
+// Секции заполняются независимо, поэтому слияние локальных результатов потоков идёт параллельно.
+class JoinHashTable {
+public:
+    using Partition = std::unordered_multimap<Value, Row>;
+
+    explicit JoinHashTable(size_t partitionCount);
+
+    size_t getPartitionIndex(const Value& key) const;
+    size_t getPartitionCount() const;
+    Partition& getPartition(size_t index);
+    const Partition& getPartitionFor(const Value& key) const;
+    size_t size() const;
+
+private:
+    std::vector<Partition> partitions_;
+};
+
+// Соединение по равенству: к колонкам строки добавляются колонки всех совпавших строк построения
+class HashJoinProbeOperator : public Operator {
+public:
+    HashJoinProbeOperator(std::unique_ptr<Operator> child, const JoinHashTable& hashTable, size_t keyColumn);
+    bool next(Batch& batch) override;
+
+private:
+    std::unique_ptr<Operator> child_;
+    const JoinHashTable& hashTable_;
+    size_t keyColumn_;
+    Batch input_;
+};
+
+enum class AggregateFunction {
+    Count,
+    Sum,
+    Min,
+    Max
+};
+
+struct Aggregate {
+    AggregateFunction function;
+    size_t column; // Не используется для Count
+};
+
+// Выполнение запросов по морселям: каждый поток пула строит свой экземпляр конвейера
+// для очередного морселя таблицы, накапливает результат локально, в конце результаты сливаются.
+class QueryExecutor {
+public:
+    // Строит операторы над сканированием морселя; nullptr - только сканирование
+    using PipelineFactory = std::function<std::unique_ptr<Operator>(std::unique_ptr<Operator> scan)>;
+
+    explicit QueryExecutor(size_t numThreads, size_t pagesPerMorsel = 4);
+
+    std::vector<Row> collect(HeapFile& heapFile, const PipelineFactory& pipeline);
+
+    // Результат: колонки groupBy, затем значения агрегатов. Без groupBy результат - всегда одна строка,
+    // даже для пустого входа: Count и Sum дают 0, Min и Max - начальные INT64_MAX и INT64_MIN (NULL нет)
+    std::vector<Row> aggregate(HeapFile& heapFile, const PipelineFactory& pipeline,
+        const std::vector<size_t>& groupBy, const std::vector<Aggregate>& aggregates);
+
+    JoinHashTable buildHashTable(HeapFile& heapFile, const PipelineFactory& pipeline, size_t keyColumn);
+
+    size_t getThreadCount() const;
+    size_t getStolenCount() const;
+
+private:
+    using Sink = std::function<void(size_t workerId, const Batch& batch)>;
+
+    void run(HeapFile& heapFile, const PipelineFactory& pipeline, const Sink& sink);
+
+    WorkStealingPool pool_;
+    size_t pagesPerMorsel_;
+};
@@ -4,17 +4,51 @@
 
 #pragma once
 #include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Состояние стратегии для тёплого перезапуска
+struct ReplacementSnapshot {
+    std::vector<size_t> pages;   // В порядке вытеснения
+    std::vector<uint8_t> states; // Метаданные страниц по порядку pages (для Clock - бит обращения); пусто - нет
+    uint8_t strategyState = 0;   // Метаданные самой стратегии (для Adaptive - активная политика); 0 - нет
+};
 
 class ReplacementStrategy {
 public:
     virtual ~ReplacementStrategy() = default;
 
-    //     
+    // Уведомление о доступе к странице
     virtual void access(size_t pageIndex) = 0;
 
-    //     
+    // Уведомление о добавлении новой страницы
     virtual void addPage(size_t pageIndex) = 0;
 
-    //    
-    virtual size_t evict() = 0;
+    // Выбор страницы для замещения. Страницы, для которых canEvict возвращает false (например,
+    // закреплённые), пропускаются и остаются на своих местах; если выбрать нечего - исключение
+    virtual size_t evict(const std::function<bool(size_t)>& canEvict) = 0;
+    size_t evict() { return evict([](size_t) { return true; }); }
+
+    // Забыть страницу, которая покидает кэш не через evict (если её нет - ничего не делать)
+    virtual void removePage(size_t pageIndex) = 0;
+
+    // Забыть все страницы (буфер очищен)
+    virtual void clear() = 0;
+
+    // Страницы в порядке вытеснения: первой - та, что будет вытеснена первой
+    virtual std::vector<size_t> getEvictionOrder() const = 0;
+
+    // Переставить перечисленные страницы так, чтобы они вытеснялись в порядке order
+    // и раньше остальных. Страницы, которых нет в стратегии, пропускаются.
+    virtual void restoreOrder(const std::vector<size_t>& order) = 0;
+
+    // Снимок для тёплого перезапуска и его восстановление (как restoreOrder, но вместе с метаданными).
+    // По умолчанию стратегии нечего хранить, кроме порядка вытеснения
+    virtual ReplacementSnapshot getSnapshot() const { return { getEvictionOrder(), {}, 0 }; }
+    virtual void restoreSnapshot(const ReplacementSnapshot& snapshot) { restoreOrder(snapshot.pages); }
+
+    // Название стратегии для отчётов
+    virtual std::string getDescription() const = 0;
 };
@@ -5,40 +5,156 @@
 #include <vector>
 #include <fstream>
 #include <stdexcept>
+#include <variant>
+#include <cstdint>
+#include <cstring>
 
-//     
+// Значение поля записи: INT хранится как число, остальные типы как байтовая строка
+using Value = std::variant<int64_t, std::string>;
+using Row = std::vector<Value>;
+
+// Структура для представления колонки таблицы
 class Column {
 public:
-    std::string name;  //  
-    std::string type;  //   (, "INT", "TEXT")
-    size_t size;       //    (0  TEXT)
+    std::string name;  // Имя колонки
+    std::string type;  // Тип данных (например, "INT", "TEXT")
+    size_t size;       // Размер в байтах (0 для TEXT)
 
     Column(const std::string& name, const std::string& type, size_t size)
         : name(name), type(type), size(size) {
     }
 };
 
-//    
+// Класс для представления таблицы
 class Table {
 public:
-    std::string name;                  //  
-    std::vector<Column> columns;       //  
-    std::vector<size_t> primaryKey;    //  ,    
+    std::string name;                  // Имя таблицы
+    std::vector<Column> columns;       // Список колонок
+    std::vector<size_t> primaryKey;    // Индексы колонок, входящих в первичный ключ
 
-    // 
+    // Конструктор
     Table(const std::string& name) : name(name) {}
 
-    //    
+    // Добавление колонки в таблицу
     void addColumn(const std::string& name, const std::string& type, size_t size) {
         columns.emplace_back(name, type, size);
     }
 
-    //   
+    // Установка первичного ключа
     void setPrimaryKey(const std::vector<size_t>& key) {
         primaryKey = key;
     }
 
-    //     
+    // Индекс колонки по имени
+    size_t getColumnIndex(const std::string& columnName) const {
+        for (size_t i = 0; i < columns.size(); ++i) {
+            if (columns[i].name == columnName) {
+                return i;
+            }
+        }
+        throw std::runtime_error("Column not found: " + columnName);
+    }
+
+    // Кодирование строки в запись страницы.
+    // INT занимает size байт (значение, не помещающееся в size байт со знаком, - ошибка),
+    // колонки размера 0 хранятся как 2 байта длины и данные, остальные дополняются нулями до size байт
+    // (при декодировании нули в конце отбрасываются).
+    std::vector<uint8_t> encodeRecord(const Row& row) const {
+        std::vector<uint8_t> record;
+        encodeRecord(row, record);
+        return record;
+    }
+
+    // То же, но запись дописывается в конец record (например, после заголовка версии)
+    void encodeRecord(const Row& row, std::vector<uint8_t>& record) const {
+        if (row.size() != columns.size()) {
+            throw std::runtime_error("Row does not match table schema.");
+        }
+
+        for (size_t i = 0; i < columns.size(); ++i) {
+            const Column& column = columns[i];
+            if (column.type == "INT") {
+                if (column.size == 0 || column.size > sizeof(int64_t)) {
+                    throw std::runtime_error("Unsupported INT size for column " + column.name);
+                }
+                int64_t value = std::get<int64_t>(row[i]);
+                if (column.size < sizeof(int64_t)) {
+                    int64_t limit = int64_t(1) << (8 * column.size - 1);
+                    if (value < -limit || value >= limit) {
+                        throw std::runtime_error("Value is too wide for column " + column.name);
+                    }
+                }
+                size_t offset = record.size();
+                record.resize(offset + column.size);
+                std::memcpy(record.data() + offset, &value, column.size); // little-endian
+                continue;
+            }
+
+            const std::string& value = std::get<std::string>(row[i]);
+            if (column.size == 0) {
+                if (value.size() > UINT16_MAX) {
+                    throw std::runtime_error("Value is too long for column " + column.name);
+                }
+                uint16_t length = static_cast<uint16_t>(value.size());
+                record.push_back(static_cast<uint8_t>(length & 0xFF));
+                record.push_back(static_cast<uint8_t>(length >> 8));
+                record.insert(record.end(), value.begin(), value.end());
+            }
+            else {
+                if (value.size() > column.size) {
+                    throw std::runtime_error("Value is too long for column " + column.name);
+                }
+                record.insert(record.end(), value.begin(), value.end());
+                record.resize(record.size() + column.size - value.size(), 0);
+            }
+        }
+    }
+
+    // Декодирование записи страницы в строку
+    Row decodeRecord(const std::vector<uint8_t>& record) const {
+        Row row;
+        row.reserve(columns.size());
+        size_t offset = 0;
+        for (const auto& column : columns) {
+            size_t length = column.size;
+            if (column.type != "INT" && column.size == 0) {
+                if (offset + 2 > record.size()) {
+                    throw std::runtime_error("Record is shorter than table schema.");
+                }
+                length = record[offset] | (static_cast<size_t>(record[offset + 1]) << 8);
+                offset += 2;
+            }
+            if (offset + length > record.size()) {
+                throw std::runtime_error("Record is shorter than table schema.");
+            }
+
+            if (column.type == "INT") {
+                if (length == 0 || length > sizeof(int64_t)) {
+                    throw std::runtime_error("Unsupported INT size for column " + column.name);
+                }
+                int64_t value = 0;
+                std::memcpy(&value, record.data() + offset, length);
+                if (length < sizeof(value) && (record[offset + length - 1] & 0x80)) {
+                    value -= int64_t(1) << (8 * length); // Знаковое расширение
+                }
+                row.emplace_back(value);
+            }
+            else {
+                // Дополнение нулями у колонки фиксированного размера не входит в значение
+                size_t valueLength = length;
+                if (column.size != 0) {
+                    while (valueLength > 0 && record[offset + valueLength - 1] == 0) {
+                        --valueLength;
+                    }
+                }
+                row.emplace_back(std::string(reinterpret_cast<const char*>(record.data() + offset), valueLength));
+            }
+            offset += length;
+        }
+        return row;
+    }
+
+    // Сохранение схемы таблицы в файл
     void saveSchema(std::ofstream& file) const {
         if (!file.is_open()) {
             throw std::runtime_error("Failed to open file for writing schema.");
@@ -56,7 +172,7 @@ public:
         file << "\n";
     }
 
-    //     
+    // Загрузка схемы таблицы из файла
     static Table loadSchema(std::ifstream& file) {
         if (!file.is_open()) {
             throw std::runtime_error("Failed to open file for reading schema.");
@@ -0,0 +1,59 @@
+#include "TransactionManager.h"
+#include <algorithm>
+
+Snapshot::Snapshot(TransactionManager& manager, uint64_t timestamp)
+    : manager_(manager), timestamp_(timestamp) {
+}
+
+Snapshot::~Snapshot() {
+    manager_.releaseSnapshot(timestamp_);
+}
+
+uint64_t Snapshot::getTimestamp() const {
+    return timestamp_;
+}
+
+bool Snapshot::isVisible(uint64_t beginTs, uint64_t endTs) const {
+    return beginTs <= timestamp_ && timestamp_ < endTs;
+}
+
+
+std::shared_ptr<const Snapshot> TransactionManager::beginSnapshot() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t timestamp = getVisibleTimestamp();
+    activeSnapshots_.insert(timestamp);
+    return std::shared_ptr<const Snapshot>(new Snapshot(*this, timestamp));
+}
+
+uint64_t TransactionManager::beginWrite() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t timestamp = ++lastTimestamp_;
+    activeWrites_.insert(timestamp);
+    return timestamp;
+}
+
+void TransactionManager::endWrite(uint64_t timestamp) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    activeWrites_.erase(timestamp);
+}
+
+uint64_t TransactionManager::getOldestSnapshot() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t visible = getVisibleTimestamp();
+    return activeSnapshots_.empty() ? visible : std::min(visible, *activeSnapshots_.begin());
+}
+
+void TransactionManager::advanceTo(uint64_t timestamp) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lastTimestamp_ = std::max(lastTimestamp_, timestamp);
+}
+
+void TransactionManager::releaseSnapshot(uint64_t timestamp) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    activeSnapshots_.erase(activeSnapshots_.find(timestamp));
+}
+
+uint64_t TransactionManager::getVisibleTimestamp() const {
+    // Снимок не должен видеть изменения, которые ещё пишутся
+    return activeWrites_.empty() ? lastTimestamp_ : *activeWrites_.begin() - 1;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+
+const uint64_t INFINITE_TIMESTAMP = UINT64_MAX; // Версия ещё не заменена и не удалена
+
+class TransactionManager;
+
+// Снимок базы: видны версии, записанные с меткой времени не больше getTimestamp().
+// Пока снимок жив, сборщик мусора не удаляет нужные ему версии.
+class Snapshot {
+public:
+    ~Snapshot();
+
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+
+    uint64_t getTimestamp() const;
+
+    // Версия с интервалом жизни [beginTs, endTs) видна в снимке
+    bool isVisible(uint64_t beginTs, uint64_t endTs) const;
+
+private:
+    friend class TransactionManager;
+    Snapshot(TransactionManager& manager, uint64_t timestamp);
+
+    TransactionManager& manager_;
+    uint64_t timestamp_;
+};
+
+// Выдаёт метки времени для записи и снимков чтения (MVCC).
+// Мьютекс держится только на время выдачи метки, поэтому читатели не блокируют писателей.
+class TransactionManager {
+public:
+    std::shared_ptr<const Snapshot> beginSnapshot();
+
+    // Метка времени изменения; до endWrite снимки её не видят
+    uint64_t beginWrite();
+    void endWrite(uint64_t timestamp);
+
+    // Версии, заменённые не позже этой метки, не нужны ни одному снимку
+    uint64_t getOldestSnapshot();
+
+    // Продолжает счёт после меток, найденных в файле при открытии таблицы
+    void advanceTo(uint64_t timestamp);
+
+private:
+    friend class Snapshot;
+    void releaseSnapshot(uint64_t timestamp);
+    uint64_t getVisibleTimestamp() const; // Вызывается под mutex_
+
+    std::mutex mutex_;
+    uint64_t lastTimestamp_ = 0;
+    std::set<uint64_t> activeWrites_;
+    std::multiset<uint64_t> activeSnapshots_;
+};
@@ -0,0 +1,198 @@
+#include "WarmRestart.h"
+#include <algorithm>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+#include <cstring>
+
+namespace {
+    const char WARM_MAGIC[4] = { 'W', 'R', 'M', '2' };
+    const char WARM_MAGIC_V1[4] = { 'W', 'A', 'R', 'M' }; // Только номера страниц
+}
+
+WarmRestart::WarmRestart(BufferManager& bufferManager, const std::string& fileName, std::chrono::milliseconds saveInterval)
+    : bufferManager_(bufferManager), fileName_(fileName), saveInterval_(saveInterval) {
+    if (saveInterval_.count() > 0) {
+        saver_ = std::thread(&WarmRestart::runSaver, this);
+    }
+}
+
+WarmRestart::~WarmRestart() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    stopCondition_.notify_all();
+    if (saver_.joinable()) {
+        saver_.join();
+    }
+    if (warmup_.joinable()) {
+        warmup_.join();
+    }
+    try {
+        save();
+    }
+    catch (...) {
+        // Деструктор не бросает: без файла следующий запуск будет холодным
+    }
+}
+
+size_t WarmRestart::save() {
+    if (warming_) {
+        return 0;
+    }
+    ReplacementSnapshot snapshot = bufferManager_.getReplacementSnapshot();
+    const std::vector<size_t>& pages = snapshot.pages;
+    if (pages.empty()) {
+        return 0;
+    }
+
+    // Пишем во временный файл и переименовываем, чтобы сбой не оставил половину набора
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string tempName = fileName_ + ".tmp";
+    {
+        std::ofstream file(tempName, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to open warm restart file for writing.");
+        }
+        // [magic][count][состояние стратегии][есть ли состояния страниц][страницы][состояния страниц]
+        uint64_t count = pages.size();
+        uint8_t hasStates = snapshot.states.size() == pages.size() ? 1 : 0;
+        file.write(WARM_MAGIC, sizeof(WARM_MAGIC));
+        file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        file.write(reinterpret_cast<const char*>(&snapshot.strategyState), sizeof(snapshot.strategyState));
+        file.write(reinterpret_cast<const char*>(&hasStates), sizeof(hasStates));
+        for (size_t pageIndex : pages) {
+            uint64_t value = pageIndex;
+            file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+        if (hasStates) {
+            file.write(reinterpret_cast<const char*>(snapshot.states.data()), snapshot.states.size());
+        }
+        if (!file.good()) {
+            throw std::runtime_error("Failed to write warm restart file.");
+        }
+    }
+    std::filesystem::rename(tempName, fileName_);
+    return pages.size();
+}
+
+ReplacementSnapshot WarmRestart::load() const {
+    ReplacementSnapshot snapshot;
+    std::ifstream file(fileName_, std::ios::binary);
+    if (!file.is_open()) {
+        return snapshot;
+    }
+
+    char magic[sizeof(WARM_MAGIC)];
+    uint64_t count = 0;
+    uint8_t hasStates = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&count), sizeof(count));
+    bool legacy = std::memcmp(magic, WARM_MAGIC_V1, sizeof(WARM_MAGIC_V1)) == 0;
+    if (!legacy) {
+        file.read(reinterpret_cast<char*>(&snapshot.strategyState), sizeof(snapshot.strategyState));
+        file.read(reinterpret_cast<char*>(&hasStates), sizeof(hasStates));
+    }
+    if (!file.good() || (!legacy && std::memcmp(magic, WARM_MAGIC, sizeof(WARM_MAGIC)) != 0)) {
+        throw std::runtime_error("Invalid warm restart file.");
+    }
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t value = 0;
+        if (!file.read(reinterpret_cast<char*>(&value), sizeof(value))) {
+            throw std::runtime_error("Warm restart file is truncated.");
+        }
+        snapshot.pages.push_back(static_cast<size_t>(value));
+    }
+    if (hasStates) {
+        snapshot.states.resize(snapshot.pages.size());
+        if (!file.read(reinterpret_cast<char*>(snapshot.states.data()), snapshot.states.size())) {
+            throw std::runtime_error("Warm restart file is truncated.");
+        }
+    }
+    return snapshot;
+}
+
+size_t WarmRestart::startWarmup() {
+    if (warming_ || warmup_.joinable()) {
+        throw std::runtime_error("Warmup has already been started.");
+    }
+    ReplacementSnapshot snapshot = load();
+    if (snapshot.pages.empty()) {
+        return 0;
+    }
+    size_t count = snapshot.pages.size();
+    warming_ = true;
+    warmup_ = std::thread(&WarmRestart::runWarmup, this, std::move(snapshot));
+    return count;
+}
+
+void WarmRestart::waitWarmup() {
+    if (warmup_.joinable()) {
+        warmup_.join();
+    }
+}
+
+bool WarmRestart::isWarmupDone() const {
+    return !warming_;
+}
+
+size_t WarmRestart::getWarmedCount() const {
+    return warmed_;
+}
+
+double WarmRestart::getWarmupSeconds() const {
+    return warmupSeconds_;
+}
+
+void WarmRestart::runSaver() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopCondition_.wait_for(lock, saveInterval_, [this]() { return stop_; })) {
+        lock.unlock();
+        try {
+            save();
+        }
+        catch (...) {
+            // Не удалось сохранить - попробуем на следующем шаге
+        }
+        lock.lock();
+    }
+}
+
+void WarmRestart::runWarmup(ReplacementSnapshot snapshot) {
+    auto start = std::chrono::steady_clock::now();
+    const std::vector<size_t>& pages = snapshot.pages;
+    bool hasStates = snapshot.states.size() == pages.size();
+    try {
+        // pages - в порядке вытеснения, самые горячие в конце: с них и начинаем
+        for (size_t end = pages.size(); end > 0; ) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (stop_) {
+                    break;
+                }
+            }
+            size_t begin = end > BATCH_SIZE ? end - BATCH_SIZE : 0;
+            std::vector<size_t> batch(pages.begin() + begin, pages.begin() + end);
+            std::sort(batch.begin(), batch.end());
+            warmed_ += bufferManager_.prefetchPages(batch);
+
+            // Загруженные пакеты занимают в порядке вытеснения сохранённые места уже сейчас, а не в конце:
+            // иначе самый горячий первый пакет оказался бы первым кандидатом на вытеснение
+            ReplacementSnapshot loaded;
+            loaded.pages.assign(pages.begin() + begin, pages.end());
+            if (hasStates) {
+                loaded.states.assign(snapshot.states.begin() + begin, snapshot.states.end());
+            }
+            loaded.strategyState = snapshot.strategyState;
+            bufferManager_.restoreReplacementSnapshot(loaded);
+            end = begin;
+            std::this_thread::yield();
+        }
+    }
+    catch (...) {
+        // Страницы, которые не удалось прочитать, загрузятся по первому запросу
+    }
+    warmupSeconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    warming_ = false;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include "BufferManager.h"
+
+// Тёплый перезапуск буфера.
+// Номера страниц буфера в порядке вытеснения вместе с метаданными стратегии замещения
+// (биты обращения Clock, активная политика Adaptive) периодически и при остановке сохраняются в файл.
+// После перезапуска startWarmup загружает их в фоновом потоке: сначала самые горячие,
+// пакетами, отсортированными по номеру страницы (последовательное чтение файла).
+// Между пакетами mutex буфера отпускается, поэтому запросы не ждут конца загрузки.
+// Загрузка занимает только свободные кадры; после каждого пакета для загруженных страниц, которые ещё
+// никто не запросил, восстанавливаются сохранённые порядок вытеснения и метаданные.
+class WarmRestart {
+public:
+    // saveInterval = 0: сохранять только вызовом save и при остановке
+    WarmRestart(BufferManager& bufferManager, const std::string& fileName, std::chrono::milliseconds saveInterval);
+    ~WarmRestart(); // Останавливает потоки и сохраняет набор страниц
+
+    WarmRestart(const WarmRestart&) = delete;
+    WarmRestart& operator=(const WarmRestart&) = delete;
+
+    // Пустой буфер (например, после flushAll) и незавершённая загрузка не затирают сохранённый набор
+    size_t save(); // Возвращает число сохранённых страниц
+
+    size_t startWarmup(); // Возвращает число страниц в сохранённом наборе (0, если файла нет)
+    void waitWarmup();
+    bool isWarmupDone() const;
+    size_t getWarmedCount() const;    // Сколько страниц загружено
+    double getWarmupSeconds() const;  // Длительность загрузки (после её окончания)
+
+private:
+    static const size_t BATCH_SIZE = 16; // Страниц за один захват mutex буфера
+
+    ReplacementSnapshot load() const;
+    void runSaver();
+    void runWarmup(ReplacementSnapshot snapshot);
+
+    BufferManager& bufferManager_;
+    std::string fileName_;
+    std::chrono::milliseconds saveInterval_;
+
+    std::mutex mutex_;                 // Защищает stop_ и запись файла
+    std::condition_variable stopCondition_;
+    bool stop_ = false;
+    std::thread saver_;
+    std::thread warmup_;
+    std::atomic<bool> warming_{ false };
+    std::atomic<size_t> warmed_{ 0 };
+    std::atomic<double> warmupSeconds_{ 0 };
+};
@@ -0,0 +1,122 @@
+#include "WorkStealingPool.h"
+#include <stdexcept>
+
+WorkStealingPool::WorkStealingPool(size_t numThreads) {
+    if (numThreads == 0) {
+        throw std::invalid_argument("Thread pool needs at least one thread");
+    }
+
+    for (size_t i = 0; i < numThreads; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < numThreads; ++i) {
+        threads_.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    startCv_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::run(std::vector<Task> tasks) {
+    if (tasks.empty()) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // Соседние задачи (например, соседние морсели) попадают одному потоку
+    size_t blockSize = (tasks.size() + workers_.size() - 1) / workers_.size();
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        Worker& worker = *workers_[i / blockSize];
+        std::lock_guard<std::mutex> workerLock(worker.mutex);
+        worker.queue.push_back(std::move(tasks[i]));
+    }
+
+    pendingTasks_ = tasks.size();
+    error_ = nullptr;
+    ++generation_;
+    startCv_.notify_all();
+
+    doneCv_.wait(lock, [this]() { return pendingTasks_ == 0; });
+
+    if (error_) {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+size_t WorkStealingPool::getThreadCount() const {
+    return threads_.size();
+}
+
+size_t WorkStealingPool::getStolenCount() const {
+    return stolenCount_;
+}
+
+bool WorkStealingPool::popTask(size_t workerId, Task& task) {
+    // Сначала своя очередь
+    {
+        Worker& own = *workers_[workerId];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.queue.empty()) {
+            task = std::move(own.queue.front());
+            own.queue.pop_front();
+            return true;
+        }
+    }
+
+    // Затем крадём с конца чужих очередей
+    for (size_t offset = 1; offset < workers_.size(); ++offset) {
+        Worker& victim = *workers_[(workerId + offset) % workers_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.queue.empty()) {
+            task = std::move(victim.queue.back());
+            victim.queue.pop_back();
+            ++stolenCount_;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(size_t workerId) {
+    size_t seenGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            startCv_.wait(lock, [&]() { return stop_ || generation_ != seenGeneration; });
+            if (stop_) {
+                return;
+            }
+            seenGeneration = generation_;
+        }
+
+        Task task;
+        while (popTask(workerId, task)) {
+            try {
+                task(workerId);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_) {
+                    error_ = std::current_exception();
+                }
+            }
+            task = nullptr;
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--pendingTasks_ == 0) {
+                doneCv_.notify_all();
+            }
+        }
+    }
+}
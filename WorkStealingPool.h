@@ -0,0 +1,51 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <exception>
+
+// Пул потоков с кражей задач. Задачи раздаются потокам непрерывными блоками;
+// поток берёт задачи из начала своей очереди, а когда она пуста - из конца чужой.
+class WorkStealingPool {
+public:
+    using Task = std::function<void(size_t workerId)>;
+
+    explicit WorkStealingPool(size_t numThreads);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Выполняет все задачи и ждёт их завершения. Первое исключение из задач пробрасывается.
+    void run(std::vector<Task> tasks);
+
+    size_t getThreadCount() const;
+    size_t getStolenCount() const; // Сколько задач выполнено не своим потоком
+
+private:
+    struct Worker {
+        std::deque<Task> queue;
+        std::mutex mutex;
+    };
+
+    bool popTask(size_t workerId, Task& task);
+    void workerLoop(size_t workerId);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;                 // Защищает поля ниже
+    std::condition_variable startCv_;  // Появились новые задачи или пул останавливается
+    std::condition_variable doneCv_;   // Все задачи выполнены
+    size_t generation_ = 0;            // Номер текущего вызова run
+    size_t pendingTasks_ = 0;
+    bool stop_ = false;
+    std::exception_ptr error_;
+
+    std::atomic<size_t> stolenCount_{ 0 };
+};
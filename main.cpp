@@ -4,6 +4,12 @@
 #include <filesystem>
 #include <windows.h>
 #include <ctime>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <sstream>
+#include <functional>
+#include <algorithm>
 #include "FileManager.h"
 #include "BufferManager.h"
 #include "Page.h"
@@ -11,15 +17,24 @@
 #include "LRUReplacementStrategy.h"
 #include "FIFOReplacementStrategy.h"
 #include "ClockReplacementStrategy.h"
+#include "AdaptiveReplacementStrategy.h"
+#include "HeapFile.h"
+#include "QueryExecutor.h"
+#include "TransactionManager.h"
+#include "GarbageCollector.h"
+#include "HashIndex.h"
+#include "BulkLoader.h"
+#include "BPlusTree.h"
+#include "WarmRestart.h"
 
-const size_t RECORD_SIZE = 256;  //    (, 512 )
+const size_t RECORD_SIZE = 256;  // Размер каждой записи (например, 512 байт)
 
-//     
+// Генерация случайных данных для записи
 std::vector<uint8_t> generateRandomData() {
     std::vector<uint8_t> data(RECORD_SIZE);
     std::random_device rd;
     std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, 255);  //    0  255
+    std::uniform_int_distribution<> dis(0, 255);  // Случайные байты от 0 до 255
 
     for (size_t i = 0; i < RECORD_SIZE; ++i) {
         data[i] = dis(gen);
@@ -30,18 +45,18 @@ std::vector<uint8_t> generateRandomData() {
 
 
 void testTable() {
-    //  
+    // Создаём таблицу
     Table table("students");
 
-    //  
+    // Добавляем колонки
     table.addColumn("id", "INT", 4);
-    table.addColumn("name", "TEXT", 0);  // 0   
+    table.addColumn("name", "TEXT", 0);  // 0 для переменной длины
     table.addColumn("age", "INT", 4);
 
-    //   
-    table.setPrimaryKey({ 0 }); // id   
+    // Устанавливаем первичный ключ
+    table.setPrimaryKey({ 0 }); // id является первичным ключом
 
-    //     
+    // Сохраняем схему таблицы в файл
     std::string schemaFile = "data/schema.db";
     std::ofstream outFile(schemaFile, std::ios::binary);
     table.saveSchema(outFile);
@@ -49,7 +64,7 @@ void testTable() {
 
     std::cout << "Table schema saved to " << schemaFile << std::endl;
 
-    //     
+    // Загружаем схему таблицы из файла
     std::ifstream inFile(schemaFile, std::ios::binary);
     Table loadedTable = Table::loadSchema(inFile);
     inFile.close();
@@ -66,54 +81,76 @@ void testTable() {
         std::cout << key << " ";
     }
     std::cout << std::endl;
+
+    // Колонка фиксированного размера возвращает значение без дополняющих нулей,
+    // INT, не помещающийся в размер колонки, не кодируется
+    Table codes("codes");
+    codes.addColumn("code", "TEXT", 8);
+    codes.addColumn("small", "INT", 2);
+    Row row = { std::string("abc"), int64_t(-32768) };
+    if (codes.decodeRecord(codes.encodeRecord(row)) != row) {
+        throw std::runtime_error("Fixed-size TEXT did not survive encoding.");
+    }
+    for (int64_t wide : { int64_t(32768), int64_t(-32769), int64_t(1) << 40 }) {
+        bool thrown = false;
+        try {
+            codes.encodeRecord({ std::string("abc"), wide });
+        }
+        catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        if (!thrown) {
+            throw std::runtime_error("INT value wider than its column was truncated.");
+        }
+    }
 }
 
-//      
+// Тест с большим количеством случайных данных
 void testPageCreationAndEvictionWithRandomData(const std::string& strategyName, std::unique_ptr<ReplacementStrategy> strategy, size_t bufferSize, size_t pageCount, size_t recordsPerPage) {
-    std::cout << "\n===  : " << strategyName << " ===\n";
+    std::cout << "\n=== Тест стратегии: " << strategyName << " ===\n";
 
-    //   
+    // Создаём файловый менеджер
     FileManager manager("data/test_database_with_random_data.bin");
 
-    //      
+    // Создаём буферный менеджер с выбранной стратегией
     BufferManager bufferManager(bufferSize, "data/test_database_with_random_data.bin", std::move(strategy));
 
     size_t currentPageIndex = 0;
     Page currentPage;
 
-    //    
+    // Заполняем страницы случайными данными
     for (size_t pageIndex = 0; pageIndex < pageCount; ++pageIndex) {
         std::cout << "Writing records to page " << pageIndex << "...\n";
         for (size_t recordIndex = 0; recordIndex < recordsPerPage; ++recordIndex) {
-            auto record = generateRandomData(); //    512 
+            auto record = generateRandomData(); // Генерируем запись размером 512 байт
 
-            // ,       
+            // Проверяем, хватит ли места на странице для записи
             if (currentPage.getFreeSpace() < record.size()) {
                 std::cout << "Page " << pageIndex << " is full. Writing current page to buffer and moving to the next page.\n";
-                bufferManager.writePage(currentPageIndex++, currentPage); //   
+                bufferManager.writePage(currentPageIndex++, currentPage); // Сохраняем текущую страницу
                 std::cout << "Current page index: " << currentPageIndex << std::endl;
-                currentPage = Page();  //   
+                currentPage = Page();  // Создаём новую страницу
             }
 
-            //     
+            // Вставляем запись на текущую страницу
             currentPage.insertRecord(record);
             std::cout << "Record " << recordIndex << " written to page " << pageIndex << ".\n";
         }
     }
 
-    //     
+    // Не забываем записать последнюю страницу
     if (currentPage.getRecordCount() > 0) {
         std::cout << "Flushing last page...\n";
         bufferManager.writePage(currentPageIndex, currentPage);
     }
 
-    //  ,  ,      
+    // Читаем страницы, чтобы проверить, что они корректно хранятся в буфере
     for (size_t pageIndex = 0; pageIndex <= currentPageIndex; ++pageIndex) {
         try {
             Page& page = bufferManager.getPage(pageIndex);
             std::cout << "Page " << pageIndex << " accessed from buffer.\n";
 
-            //      
+            // Выводим данные страниц для визуальной проверки
             std::cout << "Page " << pageIndex << " data:\n";
             for (size_t recordIndex = 0; recordIndex < page.getRecordCount(); ++recordIndex) {
                 auto record = page.getRecord(recordIndex);
@@ -129,19 +166,1170 @@ void testPageCreationAndEvictionWithRandomData(const std::string& strategyName,
         }
     }
 
-    //     
+    // Сбрасываем все страницы на диск; закреплённая страница должна остаться в буфере
+    Page& pinned = bufferManager.pinPage(0);
+    size_t recordCount = pinned.getRecordCount();
+    bufferManager.flushAll();
+    size_t hits = bufferManager.getHitCount();
+    if (bufferManager.getPage(0).getRecordCount() != recordCount || bufferManager.getHitCount() != hits + 1) {
+        throw std::runtime_error("Pinned page was dropped by flushAll");
+    }
+    bufferManager.unpinPage(0);
     bufferManager.flushAll();
     std::cout << "All pages flushed to disk.\n";
 }
 
+// Тест таблицы в цепочке страниц: операции по RID и параллельный просмотр
+void testHeapFile(size_t recordCount) {
+    std::cout << "\n=== Тест HeapFile ===\n";
+
+    std::string fileName = "data/heap_test.db";
+    std::ofstream(fileName, std::ios::binary | std::ios::trunc).close(); // Пустой файл
+
+    Table table("random_data");
+    table.addColumn("data", "BLOB", RECORD_SIZE);
+
+    // Буфер вмещает всю таблицу, чтобы просмотр измерял только обработку записей
+    size_t bufferSize = recordCount;
+    BufferManager bufferManager(bufferSize, fileName, std::make_unique<LRUReplacementStrategy>());
+    TransactionManager transactionManager;
+    HeapFile heapFile = HeapFile::create(table, bufferManager, transactionManager);
+
+    std::vector<RID> rids;
+    for (size_t i = 0; i < recordCount; ++i) {
+        rids.push_back(heapFile.insertRecord(generateRandomData()));
+    }
+    std::cout << "Inserted " << recordCount << " records into " << heapFile.getPageCount() << " pages.\n";
+
+    // Обновление и удаление не меняют RID остальных записей
+    std::vector<uint8_t> updated(RECORD_SIZE, 7);
+    heapFile.updateRecord(rids[1], updated);
+    heapFile.deleteRecord(rids[0]);
+    if (heapFile.getRecord(rids[1]) != updated) {
+        throw std::runtime_error("Record changed after update of its neighbour.");
+    }
+    bool deletedVisible = true;
+    try {
+        heapFile.getRecord(rids[0]);
+    }
+    catch (const std::runtime_error&) {
+        deletedVisible = false;
+    }
+    if (deletedVisible) {
+        throw std::runtime_error("Deleted record is still readable.");
+    }
+
+    // Запись растёт на заполненной странице: она переносится, а RID остаётся прежним
+    Table notes("notes");
+    notes.addColumn("id", "INT", 4);
+    notes.addColumn("text", "TEXT", 0);
+    HeapFile noteFile = HeapFile::create(notes, bufferManager, transactionManager);
+    std::vector<RID> noteRids;
+    while (noteFile.getPageCount() < 3) {
+        noteRids.push_back(noteFile.insertRecord(notes.encodeRecord({ int64_t(noteRids.size()), std::string(20, 'a') })));
+    }
+    auto beforeGrowth = transactionManager.beginSnapshot();
+    for (size_t length : { 500, 1500, 3000, 100, 2000 }) {
+        std::vector<uint8_t> grown = notes.encodeRecord({ int64_t(0), std::string(length, 'b') });
+        noteFile.updateRecord(noteRids[0], grown);
+        noteFile.updateRecord(noteRids[1], grown);
+        if (noteFile.getRecord(noteRids[0]) != grown || noteFile.getRecord(noteRids[1]) != grown) {
+            throw std::runtime_error("Grown record lost after update.");
+        }
+    }
+    noteFile.deleteRecord(noteRids[1]);
+    size_t noteCount = 0;
+    RID noteRid;
+    std::vector<uint8_t> note;
+    for (auto it = noteFile.scan(); it.next(noteRid, note); ) {
+        ++noteCount;
+        if (noteRid == noteRids[0] && std::get<std::string>(notes.decodeRecord(note)[1]).size() != 2000) {
+            throw std::runtime_error("Scan did not follow the moved record.");
+        }
+    }
+    size_t oldCount = 0;
+    for (auto it = noteFile.scan(beforeGrowth); it.next(noteRid, note); ) {
+        if (std::get<std::string>(notes.decodeRecord(note)[1]).size() != 20) {
+            throw std::runtime_error("Old snapshot saw a grown record.");
+        }
+        ++oldCount;
+    }
+    if (noteCount != noteRids.size() - 1 || oldCount != noteRids.size()) {
+        throw std::runtime_error("Moved records are missing from scans.");
+    }
+    beforeGrowth.reset();
+    noteFile.collectGarbage();
+    noteFile.collectGarbage();
+    std::cout << "Grown records: " << noteRids.size() << " rows, " << noteCount << " after delete, "
+        << noteFile.getPageCount() << " pages.\n";
+
+    // Место, освобождённое сборкой мусора, занимают новые записи, а цепочка не растёт
+    HeapFile reuseFile = HeapFile::create(notes, bufferManager, transactionManager);
+    std::vector<RID> reuseRids;
+    while (reuseFile.getPageCount() < 3) {
+        reuseRids.push_back(reuseFile.insertRecord(notes.encodeRecord({ int64_t(reuseRids.size()), std::string(40, 'c') })));
+    }
+    size_t reusePages = reuseFile.getPageCount();
+    size_t freed = 0;
+    for (const RID& reuseRid : reuseRids) {
+        if (reuseRid.pageIndex == reuseFile.getFirstPage()) {
+            reuseFile.deleteRecord(reuseRid);
+            ++freed;
+        }
+    }
+    reuseFile.collectGarbage();
+    for (size_t i = 0; i < freed; ++i) {
+        RID reused = reuseFile.insertRecord(notes.encodeRecord({ int64_t(i), std::string(40, 'd') }));
+        if (reused.pageIndex != reuseFile.getFirstPage()) {
+            throw std::runtime_error("Inserted record did not reuse freed space.");
+        }
+    }
+    if (reuseFile.getPageCount() != reusePages) {
+        throw std::runtime_error("Heap grew although freed space was available.");
+    }
+    std::cout << "Reused space of " << freed << " deleted records without growing " << reusePages << " pages.\n";
+
+    // Повторное открытие таблицы по первой странице
+    bufferManager.flushAll();
+    TransactionManager reopenedManager;
+    HeapFile reopened(table, bufferManager, reopenedManager, heapFile.getFirstPage());
+    size_t scanned = 0;
+    size_t updatedSeen = 0;
+    RID rid;
+    std::vector<uint8_t> record;
+    for (auto it = reopened.scan(); it.next(rid, record); ) {
+        ++scanned;
+        if (rid == rids[0]) {
+            throw std::runtime_error("Deleted record returned by scan.");
+        }
+        if (rid == rids[1]) {
+            updatedSeen += record == updated ? 1 : 0;
+        }
+    }
+    std::cout << "Sequential scan returned " << scanned << " records (expected " << recordCount - 1 << ").\n";
+    if (scanned != recordCount - 1 || updatedSeen != 1) {
+        throw std::runtime_error("Sequential scan does not match inserts, update and delete.");
+    }
+
+    HeapFile reopenedNotes(notes, bufferManager, reopenedManager, noteFile.getFirstPage());
+    size_t reopenedNotesCount = 0;
+    for (auto it = reopenedNotes.scan(); it.next(rid, record); ) {
+        ++reopenedNotesCount;
+    }
+    if (reopenedNotesCount != noteCount
+        || std::get<std::string>(notes.decodeRecord(reopenedNotes.getRecord(noteRids[0]))[1]).size() != 2000) {
+        throw std::runtime_error("Moved records lost after reopening.");
+    }
+
+    // Параллельный просмотр: сумма байтов всех записей
+    size_t maxThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    double baseTime = 0;
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        std::atomic<uint64_t> checksum{ 0 };
+        std::atomic<size_t> visited{ 0 };
+        auto start = std::chrono::steady_clock::now();
+        reopened.parallelScan(threads, 4, [&](const RID&, const std::vector<uint8_t>& data) {
+            ++visited;
+            uint64_t sum = 0;
+            for (uint8_t byte : data) {
+                sum += byte;
+            }
+            checksum += sum;
+        });
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (visited != scanned) {
+            throw std::runtime_error("Parallel scan returned a different number of records.");
+        }
+        if (threads == 1) {
+            baseTime = seconds;
+        }
+        std::cout << "Threads: " << threads << ", time: " << seconds * 1000 << " ms, speedup: "
+            << baseTime / seconds << ", checksum: " << checksum << "\n";
+    }
+
+    bufferManager.flushAll();
+}
+
+// Бенчмарк исполнителя запросов: фильтр с агрегацией и соединение с агрегацией
+void testQueryExecutor(size_t orderCount, size_t customerCount) {
+    std::cout << "\n=== Тест QueryExecutor ===\n";
+
+    std::string fileName = "data/query_test.db";
+    std::ofstream(fileName, std::ios::binary | std::ios::trunc).close();
+    BufferManager bufferManager(orderCount + customerCount, fileName, std::make_unique<LRUReplacementStrategy>());
+    TransactionManager transactionManager;
+
+    Table customers("customers");
+    customers.addColumn("id", "INT", 4);
+    customers.addColumn("region", "TEXT", 0);
+    customers.setPrimaryKey({ 0 });
+
+    Table orders("orders");
+    orders.addColumn("id", "INT", 4);
+    orders.addColumn("customer", "INT", 4);
+    orders.addColumn("amount", "INT", 4);
+    orders.setPrimaryKey({ 0 });
+
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int64_t> customerDis(0, static_cast<int64_t>(customerCount) - 1);
+    std::uniform_int_distribution<int64_t> amountDis(1, 1000);
+
+    HeapFile customerFile = HeapFile::create(customers, bufferManager, transactionManager);
+    for (size_t i = 0; i < customerCount; ++i) {
+        customerFile.insertRecord(customers.encodeRecord({ int64_t(i), "region_" + std::to_string(i % 8) }));
+    }
+    HeapFile orderFile = HeapFile::create(orders, bufferManager, transactionManager);
+    for (size_t i = 0; i < orderCount; ++i) {
+        orderFile.insertRecord(orders.encodeRecord({ int64_t(i), customerDis(gen), amountDis(gen) }));
+    }
+    std::cout << "Orders: " << orderCount << " rows in " << orderFile.getPageCount() << " pages.\n";
+
+    size_t amountColumn = orders.getColumnIndex("amount");
+    size_t customerColumn = orders.getColumnIndex("customer");
+
+    size_t maxThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    double baseTime = 0;
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        QueryExecutor executor(threads);
+        auto start = std::chrono::steady_clock::now();
+
+        // SELECT customer, COUNT(*), SUM(amount) FROM orders WHERE amount >= 500 GROUP BY customer
+        auto groups = executor.aggregate(orderFile,
+            [&](std::unique_ptr<Operator> scan) -> std::unique_ptr<Operator> {
+                return std::make_unique<FilterOperator>(std::move(scan), [&](const Batch& batch, size_t row) {
+                    return std::get<int64_t>(batch.columns[amountColumn][row]) >= 500;
+                });
+            },
+            { customerColumn },
+            { { AggregateFunction::Count, 0 }, { AggregateFunction::Sum, amountColumn } });
+
+        // SELECT region, SUM(amount) FROM orders JOIN customers ON customer = customers.id GROUP BY region
+        JoinHashTable hashTable = executor.buildHashTable(customerFile, nullptr, 0);
+        auto regions = executor.aggregate(orderFile,
+            [&](std::unique_ptr<Operator> scan) -> std::unique_ptr<Operator> {
+                auto join = std::make_unique<HashJoinProbeOperator>(std::move(scan), hashTable, customerColumn);
+                return std::make_unique<ProjectOperator>(std::move(join), std::vector<size_t>{ 4, amountColumn });
+            },
+            { 0 },
+            { { AggregateFunction::Sum, 1 } });
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (threads == 1) {
+            baseTime = seconds;
+        }
+
+        // SELECT COUNT(*), SUM(amount), MAX(amount) FROM orders WHERE amount < 0: одна строка и для пустого входа
+        auto empty = executor.aggregate(orderFile,
+            [&](std::unique_ptr<Operator> scan) -> std::unique_ptr<Operator> {
+                return std::make_unique<FilterOperator>(std::move(scan), [&](const Batch& batch, size_t row) {
+                    return std::get<int64_t>(batch.columns[amountColumn][row]) < 0;
+                });
+            },
+            {},
+            { { AggregateFunction::Count, 0 }, { AggregateFunction::Sum, amountColumn }, { AggregateFunction::Max, amountColumn } });
+        if (empty.size() != 1 || std::get<int64_t>(empty[0][0]) != 0 || std::get<int64_t>(empty[0][1]) != 0) {
+            throw std::runtime_error("Aggregate without GROUP BY over empty input must return one row.");
+        }
+
+        int64_t total = 0;
+        for (const auto& row : regions) {
+            total += std::get<int64_t>(row[1]);
+        }
+        std::cout << "Threads: " << threads << ", time: " << seconds * 1000 << " ms, throughput: "
+            << static_cast<size_t>(2 * orderCount / seconds) << " rows/s, speedup: " << baseTime / seconds
+            << ", groups: " << groups.size() << ", regions: " << regions.size() << ", total amount: " << total
+            << ", stolen morsels: " << executor.getStolenCount() << "\n";
+    }
+
+    bufferManager.flushAll();
+}
+
+// Сжатие страниц: коэффициент сжатия и стоимость записи и чтения для каждого режима
+void testCompression(size_t rowCount) {
+    std::cout << "\n=== Тест сжатия страниц ===\n";
+
+    Table orders("orders");
+    orders.addColumn("id", "INT", 4);
+    orders.addColumn("customer", "INT", 4);
+    orders.addColumn("amount", "INT", 4);
+    orders.addColumn("status", "TEXT", 0);
+
+    const char* statuses[] = { "new", "paid", "shipped", "delivered" };
+    std::vector<std::pair<std::string, CompressionMode>> modes = {
+        { "None", CompressionMode::None }, { "Fast", CompressionMode::Fast }, { "High", CompressionMode::High } };
+
+    for (const auto& mode : modes) {
+        std::string fileName = "data/compression_" + mode.first + ".db";
+        std::ofstream(fileName, std::ios::binary | std::ios::trunc).close();
+        std::filesystem::remove(fileName + ".map");
+
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<int64_t> amountDis(1, 1000);
+
+        // Маленький буфер: страницы записываются на диск при вытеснении
+        auto start = std::chrono::steady_clock::now();
+        size_t firstPage = 0;
+        CompressionStats writeStats;
+        {
+            BufferManager bufferManager(64, fileName, std::make_unique<LRUReplacementStrategy>(), mode.second);
+            TransactionManager transactionManager;
+            HeapFile heapFile = HeapFile::create(orders, bufferManager, transactionManager);
+            firstPage = heapFile.getFirstPage();
+            for (size_t i = 0; i < rowCount; ++i) {
+                heapFile.insertRecord(orders.encodeRecord({ int64_t(i), int64_t(i % 1000), amountDis(gen), statuses[i % 4] }));
+            }
+            bufferManager.flushAll();
+            writeStats = bufferManager.getCompressionStats();
+        }
+        double writeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        size_t scanned = 0;
+        CompressionStats readStats;
+        {
+            BufferManager bufferManager(64, fileName, std::make_unique<LRUReplacementStrategy>(), mode.second);
+            TransactionManager transactionManager;
+            HeapFile heapFile(orders, bufferManager, transactionManager, firstPage);
+            RID rid;
+            std::vector<uint8_t> record;
+            for (auto it = heapFile.scan(); it.next(rid, record); ) {
+                ++scanned;
+            }
+            readStats = bufferManager.getCompressionStats();
+        }
+        double readSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        size_t diskBytes = std::filesystem::file_size(fileName);
+        std::cout << "Mode " << mode.first << ": rows " << scanned
+            << ", ratio " << double(writeStats.logicalBytes) / double(writeStats.physicalBytes)
+            << ", file size " << diskBytes << " bytes"
+            << ", write " << writeSeconds * 1000 << " ms (compress " << writeStats.compressSeconds * 1e6 / std::max<size_t>(1, writeStats.pagesWritten) << " us/page)"
+            << ", read " << readSeconds * 1000 << " ms (decompress " << readStats.decompressSeconds * 1e6 / std::max<size_t>(1, readStats.pagesRead) << " us/page)\n";
+    }
+}
+
+// Перенос сжатых страниц между экстентами: экстент из сохранённой карты не перезаписывается до её
+// следующего сохранения, а после него маленькие страницы помещаются в освободившиеся большие экстенты
+void testExtentReuse() {
+    std::cout << "\n=== Тест повторного использования экстентов ===\n";
+
+    std::string fileName = "data/extent_test.db";
+    std::string savedMap = fileName + ".map.saved";
+    std::ofstream(fileName, std::ios::binary | std::ios::trunc).close();
+    std::filesystem::remove(fileName + ".map");
+
+    // Первые randomBytes байтов случайны, остальное сжимается почти полностью
+    auto makePage = [](size_t randomBytes) {
+        Page page;
+        std::mt19937 gen(static_cast<unsigned>(randomBytes));
+        std::fill(page.getData().begin(), page.getData().end(), uint8_t(0));
+        for (size_t i = 0; i < randomBytes; ++i) {
+            page.getData()[i] = static_cast<uint8_t>(gen());
+        }
+        return page;
+    };
+    Page small = makePage(100);
+    Page medium = makePage(1000);
+    Page large = makePage(3000);
+    Page other = makePage(50);
+
+    {
+        FileManager manager(fileName, CompressionMode::Fast);
+        manager.writePage(0, small);
+        manager.writePage(1, small);
+        manager.saveIndex();
+    }
+    std::filesystem::copy_file(fileName + ".map", savedMap, std::filesystem::copy_options::overwrite_existing);
+
+    // Страница 0 растёт и переезжает; пока карта не сохранена, её старое место занимать нельзя
+    {
+        FileManager manager(fileName, CompressionMode::Fast);
+        manager.writePage(0, medium);
+        manager.writePage(2, other);
+    }
+    // Сбой до записи новой карты: на диске осталась сохранённая ранее карта
+    std::filesystem::copy_file(savedMap, fileName + ".map", std::filesystem::copy_options::overwrite_existing);
+    std::filesystem::remove(savedMap);
+    {
+        FileManager manager(fileName, CompressionMode::Fast);
+        if (manager.readPage(0).getData() != small.getData() || manager.readPage(1).getData() != small.getData()) {
+            throw std::runtime_error("Extent was reused before the page map was saved.");
+        }
+    }
+
+    // После сохранения карты освободившиеся экстенты делятся между маленькими страницами
+    size_t fileSize = 0;
+    {
+        FileManager manager(fileName, CompressionMode::Fast);
+        manager.writePage(0, medium);
+        manager.writePage(0, large);
+        manager.saveIndex();
+        fileSize = std::filesystem::file_size(fileName);
+        for (size_t pageIndex = 2; pageIndex < 5; ++pageIndex) {
+            manager.writePage(pageIndex, other);
+        }
+    }
+    {
+        FileManager manager(fileName, CompressionMode::Fast);
+        bool intact = manager.readPage(0).getData() == large.getData() && manager.readPage(1).getData() == small.getData();
+        for (size_t pageIndex = 2; pageIndex < 5; ++pageIndex) {
+            intact = intact && manager.readPage(pageIndex).getData() == other.getData();
+        }
+        if (!intact) {
+            throw std::runtime_error("Pages are corrupted after extent reuse.");
+        }
+    }
+    if (std::filesystem::file_size(fileName) != fileSize) {
+        throw std::runtime_error("Free extents were not reused by smaller pages.");
+    }
+
+    // Страница помещается в свой экстент, но карта с ней ещё не сохранена: после сбоя
+    // сохранённая карта должна по-прежнему описывать прежние данные страницы
+    std::filesystem::copy_file(fileName + ".map", savedMap, std::filesystem::copy_options::overwrite_existing);
+    {
+        FileManager manager(fileName, CompressionMode::Fast);
+        manager.writePage(1, other);
+    }
+    std::filesystem::copy_file(savedMap, fileName + ".map", std::filesystem::copy_options::overwrite_existing);
+    std::filesystem::remove(savedMap);
+    {
+        FileManager manager(fileName, CompressionMode::Fast);
+        if (manager.readPage(1).getData() != small.getData()) {
+            throw std::runtime_error("Page was overwritten in place before the page map was saved.");
+        }
+    }
+    std::cout << "Freed extents reused only after saving the page map, file size " << fileSize << " bytes.\n";
+}
+
+// MVCC: точечные обновления в нескольких потоках на фоне долгих просмотров.
+// Просмотр видит согласованный снимок и не останавливает писателей.
+void testMvccContention(size_t rowCount, size_t updaterCount, size_t updatesPerThread) {
+    std::cout << "\n=== Тест MVCC ===\n";
+
+    std::string fileName = "data/mvcc_test.db";
+    std::ofstream(fileName, std::ios::binary | std::ios::trunc).close();
+    std::filesystem::remove(fileName + ".map");
+
+    Table accounts("accounts");
+    accounts.addColumn("id", "INT", 4);
+    accounts.addColumn("balance", "INT", 8);
+    accounts.setPrimaryKey({ 0 });
+
+    BufferManager bufferManager(4 * rowCount, fileName, std::make_unique<LRUReplacementStrategy>());
+    TransactionManager transactionManager;
+    HeapFile heapFile = HeapFile::create(accounts, bufferManager, transactionManager);
+
+    std::vector<RID> rids;
+    for (size_t i = 0; i < rowCount; ++i) {
+        rids.push_back(heapFile.insertRecord(accounts.encodeRecord({ int64_t(i), int64_t(1000) })));
+    }
+
+    // Снимок до обновлений должен видеть исходные данные и после них
+    auto firstSnapshot = transactionManager.beginSnapshot();
+
+    // Сборщик мусора работает параллельно с обновлениями и просмотрами
+    GarbageCollector collector(std::chrono::milliseconds(5));
+    collector.addHeapFile(heapFile);
+
+    auto runUpdaters = [&](const std::function<void()>& whileRunning) {
+        std::atomic<size_t> running{ updaterCount };
+        std::vector<std::thread> threads;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t t = 0; t < updaterCount; ++t) {
+            threads.emplace_back([&, t]() {
+                std::mt19937 gen(static_cast<unsigned>(t));
+                std::uniform_int_distribution<size_t> rowDis(0, rowCount - 1);
+                for (size_t i = 0; i < updatesPerThread; ++i) {
+                    size_t row = rowDis(gen);
+                    heapFile.updateRecord(rids[row], accounts.encodeRecord({ int64_t(row), int64_t(i) }));
+                }
+                --running;
+            });
+        }
+        size_t scans = 0;
+        while (running > 0) {
+            if (whileRunning) {
+                whileRunning();
+                ++scans;
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Updates: " << updaterCount * updatesPerThread << " in " << seconds * 1000 << " ms ("
+            << static_cast<size_t>(updaterCount * updatesPerThread / seconds) << " updates/s), scans: " << scans << "\n";
+    };
+
+    auto checksum = [&](HeapFile::ScanIterator it, size_t& rows) {
+        int64_t sum = 0;
+        rows = 0;
+        RID rid;
+        std::vector<uint8_t> record;
+        while (it.next(rid, record)) {
+            sum += std::get<int64_t>(accounts.decodeRecord(record)[1]);
+            ++rows;
+        }
+        return sum;
+    };
+
+    std::cout << "Without scans: ";
+    runUpdaters(nullptr);
+
+    // Каждый просмотр дважды читает один снимок: результаты должны совпасть
+    std::cout << "With scans:    ";
+    runUpdaters([&]() {
+        auto snapshot = transactionManager.beginSnapshot();
+        size_t firstRows = 0;
+        size_t secondRows = 0;
+        int64_t first = checksum(heapFile.scan(snapshot), firstRows);
+        int64_t second = checksum(heapFile.scan(snapshot), secondRows);
+        if (firstRows != rowCount || secondRows != rowCount || first != second) {
+            throw std::runtime_error("Scan saw an inconsistent snapshot.");
+        }
+    });
+
+    size_t rows = 0;
+    if (checksum(heapFile.scan(firstSnapshot), rows) != int64_t(1000 * rowCount) || rows != rowCount) {
+        throw std::runtime_error("Old snapshot lost its versions.");
+    }
+    std::cout << "Old snapshot still sees " << rows << " original rows, version pages: " << heapFile.getVersionPageCount() << "\n";
+
+    // После закрытия снимка сборщик мусора удаляет старые версии
+    firstSnapshot.reset();
+    collector.collectNow();
+    collector.removeHeapFile(heapFile);
+    std::cout << "Garbage collector removed " << collector.getCollectedCount() << " versions.\n";
+    if (collector.getErrorCount() != 0) {
+        throw std::runtime_error("Garbage collector failed: " + collector.getLastError());
+    }
+
+    bufferManager.flushAll();
+}
+
+// Вторичный хеш-индекс: поиск по колонке вне первичного ключа без полного просмотра таблицы
+void testHashIndex(size_t rowCount) {
+    std::cout << "\n=== Тест HashIndex ===\n";
+
+    std::string fileName = "data/hash_index_test.db";
+    std::ofstream(fileName, std::ios::binary | std::ios::trunc).close();
+    std::filesystem::remove(fileName + ".map");
+
+    Table students("students");
+    students.addColumn("id", "INT", 4);
+    students.addColumn("name", "TEXT", 0);
+    students.addColumn("age", "INT", 4);
+    students.setPrimaryKey({ 0 });
+
+    BufferManager bufferManager(rowCount, fileName, std::make_unique<LRUReplacementStrategy>());
+    TransactionManager transactionManager;
+    HeapFile heapFile = HeapFile::create(students, bufferManager, transactionManager);
+
+    // Индекс по имени таблица обновляет при вставке, у каждого имени 4 записи
+    size_t nameCount = rowCount / 4;
+    HashIndex nameIndex = HashIndex::create(students, "name", bufferManager);
+    heapFile.addIndex(nameIndex);
+    std::vector<RID> rids;
+    for (size_t i = 0; i < rowCount; ++i) {
+        rids.push_back(heapFile.insertRecord(
+            students.encodeRecord({ int64_t(i), "student_" + std::to_string(i % nameCount), int64_t(18 + i % 10) })));
+    }
+
+    // Индекс по возрасту заполняется по заполненной таблице; у каждого значения много дубликатов
+    HashIndex ageIndex = HashIndex::create(students, "age", bufferManager);
+    heapFile.addIndex(ageIndex);
+    std::cout << "Rows: " << rowCount << " in " << heapFile.getPageCount() << " pages, name index: "
+        << nameIndex.getBucketCount() << " buckets (global depth " << nameIndex.getGlobalDepth() << ")\n";
+
+    size_t nameColumn = students.getColumnIndex("name");
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < nameCount; ++i) {
+        std::string name = "student_" + std::to_string(i);
+        std::vector<RID> found = nameIndex.find(name);
+        if (found.size() != 4) {
+            throw std::runtime_error("Hash index returned wrong number of rows for " + name);
+        }
+        for (const RID& rid : found) {
+            if (std::get<std::string>(students.decodeRecord(heapFile.getRecord(rid))[nameColumn]) != name) {
+                throw std::runtime_error("Hash index returned a row with another key.");
+            }
+        }
+    }
+    double indexSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Index lookups: " << nameCount << " in " << indexSeconds * 1000 << " ms, "
+        << double(nameIndex.getPageReadCount()) / nameCount << " bucket pages per lookup\n";
+
+    // Тот же поиск полным просмотром читает все страницы таблицы
+    start = std::chrono::steady_clock::now();
+    size_t matches = 0;
+    RID rid;
+    std::vector<uint8_t> record;
+    for (auto it = heapFile.scan(); it.next(rid, record); ) {
+        if (std::get<std::string>(students.decodeRecord(record)[nameColumn]) == "student_7") {
+            ++matches;
+        }
+    }
+    double scanSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Full scan for one name: " << scanSeconds * 1000 << " ms, " << heapFile.getPageCount()
+        << " pages, " << matches << " rows\n";
+
+    size_t ageMatches = ageIndex.find(int64_t(20)).size();
+    if (ageMatches != rowCount / 10) {
+        throw std::runtime_error("Hash index lost duplicate keys.");
+    }
+
+    // Изменение и удаление записи таблица отражает в своих индексах
+    heapFile.updateRecord(rids[1], students.encodeRecord({ int64_t(1), std::string("renamed"), int64_t(19) }));
+    heapFile.deleteRecord(rids[0]);
+    std::vector<RID> renamed = nameIndex.find(std::string("renamed"));
+    if (nameIndex.find(std::string("student_0")).size() != 3 || nameIndex.find(std::string("student_1")).size() != 3
+        || renamed.size() != 1 || !(renamed[0] == rids[1]) || ageIndex.find(int64_t(18)).size() != rowCount / 10 - 1) {
+        throw std::runtime_error("Hash index does not follow table changes.");
+    }
+
+    // Слот удалённой записи может занять новая; индекс не должен выдавать её по старому ключу
+    heapFile.collectGarbage();
+    RID reused = heapFile.insertRecord(students.encodeRecord({ int64_t(rowCount), std::string("newcomer"), int64_t(99) }));
+    for (const RID& rid : nameIndex.find(std::string("student_0"))) {
+        if (rid == reused) {
+            throw std::runtime_error("Hash index returned a reused slot under the old key.");
+        }
+    }
+    if (nameIndex.find(std::string("newcomer")).size() != 1 || ageIndex.find(int64_t(99)).size() != 1) {
+        throw std::runtime_error("Hash index missed an insert.");
+    }
+    heapFile.removeIndex(nameIndex);
+    heapFile.removeIndex(ageIndex);
+
+    // Повторное открытие индекса по мета-странице
+    bufferManager.flushAll();
+    HashIndex reopened(students, "name", bufferManager, nameIndex.getMetaPage());
+    if (reopened.find(std::string("student_2")).size() != 4 || reopened.getBucketCount() != nameIndex.getBucketCount()) {
+        throw std::runtime_error("Hash index changed after reopening.");
+    }
+    std::cout << "Age index: " << ageIndex.getBucketCount() << " buckets, " << ageMatches
+        << " rows with age 20; reopened name index matches.\n";
+
+    bufferManager.flushAll();
+}
+
+// Смена нагрузки: днём точечные обращения к горячим страницам, ночью просмотры таблицы.
+// Сравниваются фиксированная LRU и адаптивный выбор стратегии.
+void testAdaptiveReplacement(size_t pageCount, size_t bufferSize) {
+    std::cout << "\n=== Тест адаптивного выбора стратегии замещения ===\n";
+
+    std::string fileName = "data/adaptive_test.db";
+    std::ofstream(fileName, std::ios::binary | std::ios::trunc).close();
+    std::filesystem::remove(fileName + ".map");
+    {
+        BufferManager bufferManager(pageCount, fileName, std::make_unique<LRUReplacementStrategy>());
+        for (size_t i = 0; i < pageCount; ++i) {
+            bufferManager.allocatePage();
+        }
+        bufferManager.flushAll();
+    }
+
+    size_t hotPages = bufferSize * 3 / 4;
+    auto dayPhase = [&](BufferManager& bufferManager, std::mt19937& gen) {
+        std::uniform_int_distribution<size_t> hotDis(0, hotPages - 1);
+        std::uniform_int_distribution<size_t> allDis(0, pageCount - 1);
+        std::uniform_int_distribution<int> percent(0, 99);
+        for (size_t i = 0; i < 20000; ++i) {
+            bufferManager.getPage(percent(gen) < 90 ? hotDis(gen) : allDis(gen));
+        }
+    };
+    auto nightPhase = [&](BufferManager& bufferManager, std::mt19937& gen) {
+        // Просмотры холодной части таблицы вперемешку с обращениями к горячим страницам
+        std::uniform_int_distribution<size_t> hotDis(0, hotPages - 1);
+        for (size_t scan = 0; scan < 6; ++scan) {
+            for (size_t page = hotPages; page < pageCount; ++page) {
+                bufferManager.getPage(page);
+                bufferManager.getPage(hotDis(gen));
+            }
+        }
+    };
+
+    std::vector<std::pair<std::string, std::unique_ptr<ReplacementStrategy>>> strategies;
+    strategies.emplace_back("LRU", std::make_unique<LRUReplacementStrategy>());
+    strategies.emplace_back("Adaptive", std::make_unique<AdaptiveReplacementStrategy>(bufferSize));
+
+    std::vector<std::string> report;
+    for (auto& strategy : strategies) {
+        BufferManager bufferManager(bufferSize, fileName, std::move(strategy.second));
+        std::mt19937 gen(42);
+        std::vector<std::pair<std::string, std::function<void()>>> phases = {
+            { "day", [&]() { dayPhase(bufferManager, gen); } },
+            { "night", [&]() { nightPhase(bufferManager, gen); } },
+            { "day", [&]() { dayPhase(bufferManager, gen); } } };
+
+        for (const auto& phase : phases) {
+            size_t hits = bufferManager.getHitCount();
+            size_t misses = bufferManager.getMissCount();
+            phase.second();
+            hits = bufferManager.getHitCount() - hits;
+            misses = bufferManager.getMissCount() - misses;
+
+            std::ostringstream line;
+            line << strategy.first << ", " << phase.first << ": hit ratio " << double(hits) / double(hits + misses)
+                << ", policy: " << bufferManager.getReplacementPolicy();
+            report.push_back(line.str());
+        }
+    }
+
+    // Закреплённая страница, выбранная для вытеснения, пропускается и остаётся на своём месте
+    {
+        BufferManager bufferManager(4, fileName, std::make_unique<AdaptiveReplacementStrategy>(4));
+        bufferManager.pinPage(0);
+        for (size_t page = 1; page < 5; ++page) {
+            bufferManager.getPage(page);
+        }
+        std::vector<size_t> order = bufferManager.getResidentPages();
+        bufferManager.unpinPage(0);
+        if (order != std::vector<size_t>{ 0, 2, 3, 4 }) {
+            throw std::runtime_error("Pinned page lost its place in the eviction order.");
+        }
+    }
+
+    // Отчёт печатается после прогонов, чтобы не смешиваться с сообщениями о вытеснении
+    for (const auto& line : report) {
+        std::cout << line << "\n";
+    }
+}
+
+// Массовая загрузка из CSV и двоичного файла в сравнении со вставкой по одной записи
+void testBulkLoad(size_t rowCount) {
+    std::cout << "\n=== Тест массовой загрузки ===\n";
+
+    Table orders("orders");
+    orders.addColumn("id", "INT", 4);
+    orders.addColumn("customer", "INT", 4);
+    orders.addColumn("amount", "INT", 4);
+    orders.addColumn("status", "TEXT", 0);
+    orders.setPrimaryKey({ 0 });
+
+    // Строки в случайном порядке ключей
+    const char* statuses[] = { "new", "paid", "shipped", "delivered" };
+    std::mt19937 gen(42);
+    std::vector<int64_t> ids(rowCount);
+    for (size_t i = 0; i < rowCount; ++i) {
+        ids[i] = int64_t(i);
+    }
+    std::shuffle(ids.begin(), ids.end(), gen);
+    std::vector<Row> rows;
+    for (size_t i = 0; i < rowCount; ++i) {
+        rows.push_back({ ids[i], int64_t(ids[i] % 1000), int64_t(gen() % 1000), statuses[i % 4] });
+    }
+
+    std::string csvName = "data/bulk_load.csv";
+    std::string binaryName = "data/bulk_load.bin";
+    {
+        std::ofstream csv(csvName, std::ios::trunc);
+        std::ofstream binary(binaryName, std::ios::binary | std::ios::trunc);
+        csv << "id,customer,amount,status\n";
+        for (const auto& row : rows) {
+            csv << std::get<int64_t>(row[0]) << "," << std::get<int64_t>(row[1]) << ","
+                << std::get<int64_t>(row[2]) << "," << std::get<std::string>(row[3]) << "\n";
+            BulkLoader::writeBinaryRecord(binary, orders.encodeRecord(row));
+        }
+    }
+
+    std::vector<std::string> report;
+    auto resetFile = [](const std::string& fileName) {
+        std::ofstream(fileName, std::ios::binary | std::ios::trunc).close();
+        std::filesystem::remove(fileName + ".map");
+    };
+
+    // Вставка по одной записи через буфер
+    {
+        std::string fileName = "data/bulk_insert.db";
+        resetFile(fileName);
+        BufferManager bufferManager(256, fileName, std::make_unique<LRUReplacementStrategy>());
+        TransactionManager transactionManager;
+        auto start = std::chrono::steady_clock::now();
+        HeapFile heapFile = HeapFile::create(orders, bufferManager, transactionManager);
+        for (const auto& row : rows) {
+            heapFile.insertRecord(orders.encodeRecord(row));
+        }
+        bufferManager.flushAll();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        report.push_back("insertRecord: " + std::to_string(static_cast<size_t>(rowCount / seconds)) + " rows/s, "
+            + std::to_string(heapFile.getPageCount()) + " pages (no index)");
+    }
+
+    // Та же вставка плюс индекс, равный индексу BulkLoader: ключи сортируются и дерево строится снизу вверх
+    {
+        std::string fileName = "data/bulk_insert_index.db";
+        resetFile(fileName);
+        BufferManager bufferManager(256, fileName, std::make_unique<LRUReplacementStrategy>());
+        TransactionManager transactionManager;
+        auto start = std::chrono::steady_clock::now();
+        HeapFile heapFile = HeapFile::create(orders, bufferManager, transactionManager);
+        std::vector<std::pair<std::vector<uint8_t>, RID>> entries;
+        entries.reserve(rows.size());
+        for (const auto& row : rows) {
+            entries.emplace_back(BPlusTree::encodeRowKey(orders, row), heapFile.insertRecord(orders.encodeRecord(row)));
+        }
+        std::sort(entries.begin(), entries.end(), [](const auto& left, const auto& right) { return left.first < right.first; });
+        std::vector<std::vector<uint8_t>> keys;
+        std::vector<RID> rids;
+        for (auto& entry : entries) {
+            keys.push_back(std::move(entry.first));
+            rids.push_back(entry.second);
+        }
+        BPlusTree::build(bufferManager, keys, rids, 0.9);
+        bufferManager.flushAll();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        report.push_back("insertRecord + B+-tree build: " + std::to_string(static_cast<size_t>(rowCount / seconds)) + " rows/s");
+    }
+
+    size_t maxThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        std::string fileName = "data/bulk_load_" + std::to_string(threads) + ".db";
+        resetFile(fileName);
+        BufferManager bufferManager(256, fileName, std::make_unique<LRUReplacementStrategy>());
+        TransactionManager transactionManager;
+        BulkLoader loader(orders, bufferManager, transactionManager, threads, 0.9);
+
+        auto start = std::chrono::steady_clock::now();
+        std::ifstream csv(csvName);
+        size_t firstPage = loader.loadCsv(csv);
+        bufferManager.flushAll();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const BulkLoadStats& stats = loader.getStats();
+
+        // Проверка таблицы и индекса
+        HeapFile heapFile(orders, bufferManager, transactionManager, firstPage);
+        BPlusTree index(bufferManager, loader.getIndexRoot());
+        size_t scanned = 0;
+        RID rid;
+        std::vector<uint8_t> record;
+        for (auto it = heapFile.scan(); it.next(rid, record); ) {
+            ++scanned;
+        }
+        for (size_t i = 0; i < 1000; ++i) {
+            int64_t id = ids[i];
+            if (!index.find(BPlusTree::encodeKey(orders, { id }), rid)
+                || std::get<int64_t>(orders.decodeRecord(heapFile.getRecord(rid))[0]) != id) {
+                throw std::runtime_error("B+-tree lookup failed after bulk load.");
+            }
+        }
+        size_t range = index.findRange(BPlusTree::encodeKey(orders, { int64_t(100) }), BPlusTree::encodeKey(orders, { int64_t(199) })).size();
+        if (scanned != rowCount || range != 100) {
+            throw std::runtime_error("Bulk load lost rows.");
+        }
+
+        std::ostringstream line;
+        line << "BulkLoader CSV, threads " << threads << ": " << static_cast<size_t>(rowCount / seconds) << " rows/s, "
+            << stats.pageCount << " pages, index " << stats.indexPageCount << " pages (height " << index.getHeight() << ")"
+            << ", encode+sort " << stats.encodeSeconds * 1000 << " ms, merge " << stats.mergeSeconds * 1000
+            << " ms, write " << stats.writeSeconds * 1000 << " ms, index " << stats.indexSeconds * 1000 << " ms";
+        report.push_back(line.str());
+    }
+
+    // Двоичный файл в кодировке Table
+    {
+        std::string fileName = "data/bulk_load_binary.db";
+        resetFile(fileName);
+        BufferManager bufferManager(256, fileName, std::make_unique<LRUReplacementStrategy>());
+        TransactionManager transactionManager;
+        BulkLoader loader(orders, bufferManager, transactionManager, maxThreads);
+        auto start = std::chrono::steady_clock::now();
+        std::ifstream binary(binaryName, std::ios::binary);
+        loader.loadBinary(binary);
+        bufferManager.flushAll();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        report.push_back("BulkLoader binary: " + std::to_string(static_cast<size_t>(loader.getStats().rowCount / seconds)) + " rows/s");
+    }
+
+    // Таблица без первичного ключа: записи не сортируются и идут в порядке входа, индекс не строится
+    {
+        Table events("events");
+        events.addColumn("id", "INT", 4);
+        events.addColumn("payload", "TEXT", 0);
+        std::vector<Row> eventRows;
+        for (size_t i = 0; i < rowCount / 10; ++i) {
+            eventRows.push_back({ ids[i], "event_" + std::to_string(ids[i]) });
+        }
+
+        std::string fileName = "data/bulk_load_no_key.db";
+        resetFile(fileName);
+        BufferManager bufferManager(256, fileName, std::make_unique<LRUReplacementStrategy>());
+        TransactionManager transactionManager;
+        BulkLoader loader(events, bufferManager, transactionManager, maxThreads);
+        auto start = std::chrono::steady_clock::now();
+        size_t firstPage = loader.load(eventRows);
+        bufferManager.flushAll();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (loader.getIndexRoot() != INVALID_PAGE || loader.getStats().indexPageCount != 0) {
+            throw std::runtime_error("Bulk load built an index for a table without primary key.");
+        }
+
+        HeapFile heapFile(events, bufferManager, transactionManager, firstPage);
+        size_t scanned = 0;
+        RID rid;
+        std::vector<uint8_t> record;
+        for (auto it = heapFile.scan(); it.next(rid, record); ++scanned) {
+            if (scanned >= eventRows.size() || events.decodeRecord(record) != eventRows[scanned]) {
+                throw std::runtime_error("Bulk load without primary key changed row order.");
+            }
+        }
+        if (scanned != eventRows.size()) {
+            throw std::runtime_error("Bulk load without primary key lost rows.");
+        }
+        report.push_back("BulkLoader without primary key: " + std::to_string(static_cast<size_t>(eventRows.size() / seconds)) + " rows/s");
+    }
+
+    for (const auto& line : report) {
+        std::cout << line << "\n";
+    }
+}
+
+// Восстановление доли попаданий после перезапуска: холодный буфер против тёплого перезапуска
+void testWarmRestart(size_t pageCount, size_t bufferSize) {
+    std::cout << "\n=== Тест тёплого перезапуска буфера ===\n";
+
+    std::string fileName = "data/warm_restart_test.db";
+    std::string warmName = fileName + ".warm";
+    std::ofstream(fileName, std::ios::binary | std::ios::trunc).close();
+    std::filesystem::remove(fileName + ".map");
+    std::filesystem::remove(warmName);
+    {
+        BufferManager bufferManager(pageCount, fileName, std::make_unique<LRUReplacementStrategy>());
+        for (size_t i = 0; i < pageCount; ++i) {
+            bufferManager.allocatePage();
+        }
+        bufferManager.flushAll();
+    }
+
+    // Горячие страницы разбросаны по файлу
+    std::mt19937 gen(7);
+    std::vector<size_t> allPages(pageCount);
+    for (size_t i = 0; i < pageCount; ++i) {
+        allPages[i] = i;
+    }
+    std::shuffle(allPages.begin(), allPages.end(), gen);
+    std::vector<size_t> hotPages(allPages.begin(), allPages.begin() + bufferSize * 3 / 4);
+
+    auto nextPage = [&](std::mt19937& random) {
+        std::uniform_int_distribution<size_t> hotDis(0, hotPages.size() - 1);
+        std::uniform_int_distribution<size_t> allDis(0, pageCount - 1);
+        std::uniform_int_distribution<int> percent(0, 99);
+        return percent(random) < 95 ? hotPages[hotDis(random)] : allDis(random);
+    };
+
+    // Запросы приходят пачками по 50 раз в миллисекунду, как от клиентов сервера
+    const size_t windowSize = 500;
+    const size_t windowCount = 8;
+    const size_t burstSize = 50;
+    auto runWindows = [&](BufferManager& bufferManager, std::mt19937& random, double& maxLatency) {
+        std::vector<double> ratios;
+        for (size_t window = 0; window < windowCount; ++window) {
+            size_t hits = bufferManager.getHitCount();
+            size_t misses = bufferManager.getMissCount();
+            for (size_t i = 0; i < windowSize; ++i) {
+                if (i % burstSize == 0) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                auto start = std::chrono::steady_clock::now();
+                bufferManager.getPage(nextPage(random));
+                maxLatency = std::max(maxLatency, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+            }
+            hits = bufferManager.getHitCount() - hits;
+            misses = bufferManager.getMissCount() - misses;
+            ratios.push_back(double(hits) / double(hits + misses));
+        }
+        return ratios;
+    };
+    auto formatRatios = [](const std::vector<double>& ratios) {
+        std::ostringstream line;
+        for (double ratio : ratios) {
+            line << " " << static_cast<int>(ratio * 100) << "%";
+        }
+        return line.str();
+    };
+
+    std::vector<std::string> report;
+    std::vector<size_t> savedPages;
+    {
+        // Работа до остановки: набор страниц сохраняется периодически и при остановке
+        BufferManager bufferManager(bufferSize, fileName, std::make_unique<LRUReplacementStrategy>());
+        WarmRestart warmRestart(bufferManager, warmName, std::chrono::milliseconds(20));
+        std::mt19937 random(1);
+        double maxLatency = 0;
+        for (size_t i = 0; i < 20000; ++i) {
+            bufferManager.getPage(nextPage(random));
+        }
+        std::vector<double> ratios = runWindows(bufferManager, random, maxLatency);
+        savedPages = bufferManager.getResidentPages();
+        report.push_back("Steady state:" + formatRatios(ratios));
+    }
+
+    // Без нагрузки загрузка должна восстановить и страницы, и порядок вытеснения
+    {
+        BufferManager bufferManager(bufferSize, fileName, std::make_unique<LRUReplacementStrategy>());
+        WarmRestart warmRestart(bufferManager, warmName, std::chrono::milliseconds(0));
+        warmRestart.startWarmup();
+        warmRestart.waitWarmup();
+        if (bufferManager.getResidentPages() != savedPages) {
+            throw std::runtime_error("Warm restart did not restore the buffer state.");
+        }
+        std::ostringstream line;
+        line << "Warmup: " << warmRestart.getWarmedCount() << " pages in " << warmRestart.getWarmupSeconds() * 1000 << " ms";
+        report.push_back(line.str());
+    }
+
+    // Вместе с порядком сохраняются биты обращения Clock и активная политика Adaptive
+    {
+        std::string clockName = fileName + ".clock";
+        std::filesystem::remove(clockName);
+        ReplacementSnapshot saved;
+        {
+            BufferManager bufferManager(bufferSize, fileName, std::make_unique<AdaptiveReplacementStrategy>(bufferSize, ReplacementPolicy::Clock));
+            WarmRestart warmRestart(bufferManager, clockName, std::chrono::milliseconds(0));
+            std::mt19937 random(3);
+            for (size_t i = 0; i < 5000; ++i) {
+                bufferManager.getPage(nextPage(random));
+            }
+            saved = bufferManager.getReplacementSnapshot();
+        }
+        BufferManager bufferManager(bufferSize, fileName, std::make_unique<AdaptiveReplacementStrategy>(bufferSize, ReplacementPolicy::LRU));
+        WarmRestart warmRestart(bufferManager, clockName, std::chrono::milliseconds(0));
+        warmRestart.startWarmup();
+        warmRestart.waitWarmup();
+        ReplacementSnapshot restored = bufferManager.getReplacementSnapshot();
+        if (restored.pages != saved.pages || restored.states != saved.states || restored.strategyState != saved.strategyState
+            || std::count(saved.states.begin(), saved.states.end(), 1) == 0) {
+            throw std::runtime_error("Warm restart did not restore replacement metadata.");
+        }
+    }
+
+    // Страница, запрошенная во время загрузки, не отдаёт своё место сохранённому порядку
+    {
+        BufferManager bufferManager(bufferSize, fileName, std::make_unique<LRUReplacementStrategy>());
+        bufferManager.prefetchPages({ 1, 2, 3 });
+        bufferManager.getPage(2);
+        bufferManager.restoreReplacementSnapshot({ { 3, 2, 1 }, {}, 0 });
+        if (bufferManager.getResidentPages() != std::vector<size_t>{ 3, 1, 2 }) {
+            throw std::runtime_error("Warm restart demoted a page requested during warmup.");
+        }
+    }
+
+    for (bool warm : { false, true }) {
+        // Холодный запуск без WarmRestart, чтобы он не перезаписал сохранённый набор
+        BufferManager bufferManager(bufferSize, fileName, std::make_unique<LRUReplacementStrategy>());
+        std::unique_ptr<WarmRestart> warmRestart;
+        if (warm) {
+            warmRestart = std::make_unique<WarmRestart>(bufferManager, warmName, std::chrono::milliseconds(0));
+            warmRestart->startWarmup(); // Запросы идут сразу, не дожидаясь загрузки
+        }
+        std::mt19937 random(2);
+        double maxLatency = 0;
+        std::vector<double> ratios = runWindows(bufferManager, random, maxLatency);
+        std::ostringstream line;
+        line << (warm ? "Warm restart" : "Cold start") << ", hit ratio per " << windowSize << " requests:"
+            << formatRatios(ratios) << ", max request latency " << maxLatency * 1000 << " ms";
+        if (warm) {
+            warmRestart->waitWarmup();
+            line << ", " << warmRestart->getWarmedCount() << " pages loaded in background in " << warmRestart->getWarmupSeconds() * 1000 << " ms";
+        }
+        report.push_back(line.str());
+    }
+
+    for (const auto& line : report) {
+        std::cout << line << "\n";
+    }
+}
+
+// Второй сжатый уровень буфера: рабочий набор в полтора раза больше буфера
+void testSecondTier(size_t rowCount, size_t bufferSize, size_t workingSetPages) {
+    std::cout << "\n=== Тест второго уровня буфера ===\n";
+
+    Table orders("orders");
+    orders.addColumn("id", "INT", 4);
+    orders.addColumn("customer", "INT", 4);
+    orders.addColumn("amount", "INT", 4);
+    orders.addColumn("status", "TEXT", 0);
+
+    std::string fileName = "data/second_tier_test.db";
+    std::ofstream(fileName, std::ios::binary | std::ios::trunc).close();
+    std::filesystem::remove(fileName + ".map");
+    {
+        const char* statuses[] = { "new", "paid", "shipped", "delivered" };
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<int64_t> amountDis(1, 1000);
+        BufferManager bufferManager(64, fileName, std::make_unique<LRUReplacementStrategy>());
+        TransactionManager transactionManager;
+        HeapFile heapFile = HeapFile::create(orders, bufferManager, transactionManager);
+        for (size_t i = 0; i < rowCount; ++i) {
+            heapFile.insertRecord(orders.encodeRecord({ int64_t(i), int64_t(i % 1000), amountDis(gen), statuses[i % 4] }));
+        }
+        bufferManager.flushAll();
+    }
+
+    // Второй уровень получает четверть памяти первого
+    size_t budget = bufferSize * PAGE_SIZE / 4;
+    std::vector<std::string> report;
+    for (bool tiered : { false, true }) {
+        std::unique_ptr<CompressedPageCache> secondTier;
+        if (tiered) {
+            secondTier = std::make_unique<CompressedPageCache>(budget, std::make_unique<LRUReplacementStrategy>());
+        }
+        BufferManager bufferManager(bufferSize, fileName, std::make_unique<LRUReplacementStrategy>(),
+            CompressionMode::None, std::move(secondTier));
+        bufferManager.setLogging(false); // Вывод в консоль исказил бы задержки
+
+        // Задержка каждого запроса относится к уровню, который его обслужил
+        std::mt19937 gen(1);
+        std::uniform_int_distribution<size_t> pageDis(0, workingSetPages - 1);
+        double seconds[3] = { 0, 0, 0 }; // Буфер, второй уровень, диск
+        size_t counts[3] = { 0, 0, 0 };
+        for (size_t i = 0; i < 50000; ++i) {
+            size_t misses = bufferManager.getMissCount();
+            size_t tierHits = bufferManager.getSecondTierStats().hits;
+            auto start = std::chrono::steady_clock::now();
+            bufferManager.getPage(pageDis(gen));
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            size_t level = bufferManager.getMissCount() == misses ? 0 : (bufferManager.getSecondTierStats().hits != tierHits ? 1 : 2);
+            // Первые запросы заполняют буфер и не показательны
+            if (i >= 10000) {
+                seconds[level] += elapsed;
+                ++counts[level];
+            }
+        }
+
+        CompressedCacheStats stats = bufferManager.getSecondTierStats();
+        size_t total = counts[0] + counts[1] + counts[2];
+        std::ostringstream line;
+        line << (tiered ? "Buffer + compressed tier" : "Buffer only") << ": cached pages " << bufferSize + stats.pagesStored
+            << " (memory " << (bufferSize * PAGE_SIZE + stats.bytesStored) / 1024 << " KB)"
+            << ", buffer hits " << 100.0 * counts[0] / total << "%, tier-2 hits " << 100.0 * counts[1] / total
+            << "%, disk reads " << 100.0 * counts[2] / total << "%";
+        if (tiered) {
+            line << ", tier-2 ratio " << double(stats.pagesStored * PAGE_SIZE) / double(std::max<size_t>(1, stats.bytesStored))
+                << ", tier-2 hit " << seconds[1] * 1e6 / std::max<size_t>(1, counts[1]) << " us (decompress "
+                << stats.decompressSeconds * 1e6 / std::max<size_t>(1, stats.hits) << " us, compress on eviction "
+                << stats.compressSeconds * 1e6 / std::max<size_t>(1, stats.hits + stats.pagesStored + stats.evictions) << " us)";
+        }
+        line << ", disk read " << seconds[2] * 1e6 / std::max<size_t>(1, counts[2]) << " us";
+        report.push_back(line.str());
+    }
+
+    for (const auto& line : report) {
+        std::cout << line << "\n";
+    }
+}
+
 int main() {
-    //     UTF-8
+    // Установим кодировку консоли на UTF-8
     setlocale(LC_CTYPE, "");
     SetConsoleOutputCP(CP_UTF8);
-    system("chcp 65001 > nul"); //    UTF-8
+    system("chcp 65001 > nul"); // Переключение консоли на UTF-8
 
     try {
-        //   
+        // Проверка существования директории
         if (!std::filesystem::exists("data")) {
             std::cout << "Directory does not exist, creating it...\n";
             std::filesystem::create_directory("data");
@@ -149,22 +1337,50 @@ int main() {
 
         std::cout << "Current working directory: " << std::filesystem::current_path() << std::endl;
 
-        //   Table
+        // Тестирование класса Table
         testTable();
 
 
-        //    
-        size_t pageCount = 3;  //    
-        size_t bufferSize = 30;   //  
-        size_t recordsPerPage = 10;  //    
+        // Настроим параметры для теста
+        size_t pageCount = 3;  // Количество страниц для теста
+        size_t bufferSize = 30;   // Размер буфера
+        size_t recordsPerPage = 10;  // Количество записей на странице
 
-        //   FIFO    
+        // Тест стратегии FIFO с большим объемом данных
         testPageCreationAndEvictionWithRandomData("FIFO", std::make_unique<FIFOReplacementStrategy>(), bufferSize, pageCount, recordsPerPage);
 
-        //   LRU    
+        // Тест таблицы в цепочке страниц
+        testHeapFile(20000);
+
+        // Бенчмарк параллельного исполнения запросов
+        testQueryExecutor(200000, 1000);
+
+        // Сжатие холодных страниц
+        testCompression(100000);
+        testExtentReuse();
+
+        // Обновления на фоне просмотров
+        testMvccContention(20000, 4, 20000);
+
+        // Поиск по вторичному хеш-индексу
+        testHashIndex(100000);
+
+        // Смена стратегии замещения при смене нагрузки
+        testAdaptiveReplacement(2000, 256);
+
+        // Массовая загрузка
+        testBulkLoad(200000);
+
+        // Тёплый перезапуск буфера
+        testWarmRestart(8000, 1024);
+
+        // Сжатый второй уровень буфера
+        testSecondTier(100000, 256, 384);
+
+        // Тест стратегии LRU с большим объемом данных
       //  testPageCreationAndEvictionWithRandomData("LRU", std::make_unique<LRUReplacementStrategy>(), bufferSize, pageCount, recordsPerPage);
 
-        //   Clock    
+        // Тест стратегии Clock с большим объемом данных
      //   testPageCreationAndEvictionWithRandomData("Clock", std::make_unique<ClockReplacementStrategy>(bufferSize), bufferSize, pageCount, recordsPerPage);
 
     }